@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <task_pool/algorithms.h>
+#include <task_pool/pool.h>
+#include <vector>
+
+namespace {
+void work( double& value )
+{
+    value = std::sqrt( value + 1.0 );
+}
+} // namespace
+
+static void naive_submit( benchmark::State& state )
+{
+    be::task_pool                      pool;
+    std::vector< double >              values( static_cast< std::size_t >( state.range( 0 ) ), 1.0 );
+    std::vector< std::future< void > > futures;
+    futures.reserve( values.size() );
+    for ( auto _ : state ) // NOLINT
+    {
+        futures.clear();
+        for ( auto& value : values )
+        {
+            futures.push_back( pool.submit( std::launch::async, &work, std::ref( value ) ) );
+        }
+        for ( auto& future : futures )
+        {
+            future.get();
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( naive_submit )->Arg( 1'000 )->Arg( 100'000 )->UseRealTime();
+
+static void parallel_for( benchmark::State& state )
+{
+    be::task_pool         pool;
+    std::vector< double > values( static_cast< std::size_t >( state.range( 0 ) ), 1.0 );
+    for ( auto _ : state ) // NOLINT
+    {
+        be::parallel_for( pool, values.begin(), values.end(), &work );
+    }
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( parallel_for )->Arg( 1'000 )->Arg( 100'000 )->UseRealTime();
+
+static void parallel_reduce( benchmark::State& state )
+{
+    be::task_pool         pool;
+    std::vector< double > values( static_cast< std::size_t >( state.range( 0 ) ), 1.0 );
+    for ( auto _ : state ) // NOLINT
+    {
+        benchmark::DoNotOptimize(
+            be::parallel_reduce( pool, values.begin(), values.end(), 0.0, std::plus<>{} ) );
+    }
+    state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( parallel_reduce )->Arg( 1'000 )->Arg( 100'000 )->UseRealTime();
@@ -0,0 +1,42 @@
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <task_pool/pool.h>
+#include <vector>
+
+#if defined( TASKPOOL_BENCH_BOOST )
+#    include <boost/pool/pool_alloc.hpp>
+#endif
+
+// Submits batches of tasks too large to be stored inline so every task goes through the allocator
+template< typename Allocator >
+static void allocator_submit( benchmark::State& state )
+{
+    constexpr std::size_t                          batch = 1'000;
+    be::task_pool_t< Allocator >                   pool( 1, Allocator() );
+    std::vector< std::future< std::size_t > >      futures;
+    std::array< std::size_t, BE_TASK_INLINE_SIZE > payload{};
+    futures.reserve( batch );
+    for ( auto _ : state ) // NOLINT
+    {
+        futures.clear();
+        for ( std::size_t i = 0; i < batch; ++i )
+        {
+            futures.push_back(
+                pool.submit( std::launch::async, [payload]() { return payload[0]; } ) );
+        }
+        for ( auto& future : futures )
+        {
+            benchmark::DoNotOptimize( future.get() );
+        }
+    }
+    state.SetItemsProcessed( static_cast< std::int64_t >( state.iterations() * batch ) );
+}
+BENCHMARK_TEMPLATE( allocator_submit, std::allocator< void > )->UseRealTime();
+#if defined( TASKPOOL_BENCH_BOOST )
+// the allocator used by the webserver example
+BENCHMARK_TEMPLATE( allocator_submit, boost::fast_pool_allocator< char > )->UseRealTime();
+#endif
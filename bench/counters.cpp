@@ -0,0 +1,82 @@
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <task_pool/pool.h>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int increments = 1'000;
+
+std::atomic< std::ptrdiff_t > s_shared{ 0 };
+be::detail::sharded_counter   s_sharded( 64 );
+} // namespace
+
+// Every thread counting on the same cache line, as the pool did before sharding its counters
+static void shared_counter( benchmark::State& state )
+{
+    for ( auto _ : state ) // NOLINT
+    {
+        for ( int i = 0; i < increments; ++i )
+        {
+            s_shared.fetch_add( 1 );
+            s_shared.fetch_add( -1 );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * increments );
+}
+BENCHMARK( shared_counter )->ThreadRange( 1, 64 )->UseRealTime();
+
+// Every thread counting in a slot of its own
+static void sharded_counter( benchmark::State& state )
+{
+    auto const slot = static_cast< std::size_t >( state.thread_index() ) % s_sharded.size();
+    for ( auto _ : state ) // NOLINT
+    {
+        for ( int i = 0; i < increments; ++i )
+        {
+            s_sharded.add( slot, 1 );
+            s_sharded.add( slot, -1 );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * increments );
+}
+BENCHMARK( sharded_counter )->ThreadRange( 1, 64 )->UseRealTime();
+
+// Empty tasks per second when every thread submits and runs tasks. Work stealing threads use
+// their own deques so the pool wide counters are the only cache lines they share, the shared
+// queue of the default policy adds its per level counters
+template< be::schedule_policy Policy >
+static void fan_out( benchmark::State& state )
+{
+    constexpr std::size_t children = 1'000;
+    be::pool_options      options;
+    options.thread_count = static_cast< unsigned >( state.range( 0 ) );
+    options.scheduling   = Policy;
+    be::task_pool pool( options );
+    for ( auto _ : state ) // NOLINT
+    {
+        for ( unsigned t = 0; t < options.thread_count; ++t )
+        {
+            auto future = pool.submit( std::launch::async, [&pool]() {
+                for ( std::size_t i = 0; i < children; ++i )
+                {
+                    auto child = pool.submit( std::launch::async, []() {} );
+                }
+            } );
+        }
+        pool.wait();
+    }
+    state.SetItemsProcessed(
+        static_cast< std::int64_t >( state.iterations() * options.thread_count * children ) );
+}
+BENCHMARK_TEMPLATE( fan_out, be::schedule_policy::shared_queue )
+    ->RangeMultiplier( 2 )
+    ->Range( 1, std::max( 2U, std::thread::hardware_concurrency() ) )
+    ->UseRealTime();
+BENCHMARK_TEMPLATE( fan_out, be::schedule_policy::work_stealing )
+    ->RangeMultiplier( 2 )
+    ->Range( 1, std::max( 2U, std::thread::hardware_concurrency() ) )
+    ->UseRealTime();
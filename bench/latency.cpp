@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <task_pool/pool.h>
+#include <vector>
+
+namespace {
+double percentile( std::vector< double >& samples, double const fraction )
+{
+    if ( samples.empty() )
+    {
+        return 0.0;
+    }
+    auto const index =
+        static_cast< std::size_t >( fraction * static_cast< double >( samples.size() - 1U ) );
+    auto const nth = samples.begin() + static_cast< std::ptrdiff_t >( index );
+    std::nth_element( samples.begin(), nth, samples.end() );
+    return *nth;
+}
+} // namespace
+
+// Time from submitting an empty task until get() returns on the submitting thread
+static void round_trip( benchmark::State& state )
+{
+    be::task_pool         pool( static_cast< unsigned >( state.range( 0 ) ) );
+    std::vector< double > samples;
+    for ( auto _ : state ) // NOLINT
+    {
+        auto const start  = std::chrono::steady_clock::now();
+        auto       future = pool.submit( std::launch::async, []() {} );
+        future.get();
+        auto const stop = std::chrono::steady_clock::now();
+        samples.push_back( std::chrono::duration< double, std::nano >( stop - start ).count() );
+    }
+    state.counters["p50_ns"] = percentile( samples, 0.50 );
+    state.counters["p99_ns"] = percentile( samples, 0.99 );
+}
+BENCHMARK( round_trip )->Arg( 1 )->Arg( 4 )->UseRealTime();
+
+// Empty tasks per second with every thread of the pool busy, submitted from the calling thread
+static void throughput( benchmark::State& state )
+{
+    constexpr std::size_t      batch = 10'000;
+    be::task_pool              pool( static_cast< unsigned >( state.range( 0 ) ) );
+    std::atomic< std::size_t > done{ 0 };
+    for ( auto _ : state ) // NOLINT
+    {
+        for ( std::size_t i = 0; i < batch; ++i )
+        {
+            auto future = pool.submit( std::launch::async, [&done]() { ++done; } );
+        }
+        pool.wait();
+    }
+    benchmark::DoNotOptimize( done.load() );
+    state.SetItemsProcessed( static_cast< std::int64_t >( state.iterations() * batch ) );
+}
+BENCHMARK( throughput )->RangeMultiplier( 2 )->Range( 1, 16 )->UseRealTime();
@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+#include <future>
+#include <task_pool/futures.h>
+#include <task_pool/pool.h>
+
+// Baseline, the argument is passed by value
+static void eager_argument( benchmark::State& state )
+{
+    be::task_pool pool( 1 );
+    for ( auto _ : state ) // NOLINT
+    {
+        auto future = pool.submit( std::launch::async, []( int x ) { return x; }, 1 );
+        benchmark::DoNotOptimize( future.get() );
+    }
+}
+BENCHMARK( eager_argument )->UseRealTime();
+
+// std::future arguments can not notify so the task goes into one of the check shards and is
+// polled every check_latency until the argument is ready
+template< typename Promise >
+static void lazy_argument( benchmark::State& state )
+{
+    be::task_pool pool( 1 );
+    for ( auto _ : state ) // NOLINT
+    {
+        Promise promise;
+        auto    future =
+            pool.submit( std::launch::async, []( int x ) { return x; }, promise.get_future() );
+        promise.set_value( 1 );
+        benchmark::DoNotOptimize( future.get() );
+    }
+}
+BENCHMARK_TEMPLATE( lazy_argument, std::promise< int > )->UseRealTime();
+BENCHMARK_TEMPLATE( lazy_argument, be::notifying_promise< int > )->UseRealTime();
+BENCHMARK_TEMPLATE( lazy_argument, be::promise< int > )->UseRealTime();
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+#include <future>
+#include <task_pool/pipes.h>
+#include <task_pool/pool.h>
+
+namespace {
+int first()
+{
+    return 1;
+}
+int next( int x )
+{
+    return x + 1;
+}
+} // namespace
+
+// Three dependent tasks, each waited for before submitting the next
+static void submit_chain( benchmark::State& state )
+{
+    be::task_pool pool( 1 );
+    for ( auto _ : state ) // NOLINT
+    {
+        int x = pool.submit( std::launch::async, &first ).get();
+        x     = pool.submit( std::launch::async, &next, x ).get();
+        x     = pool.submit( std::launch::async, &next, x ).get();
+        benchmark::DoNotOptimize( x );
+    }
+}
+BENCHMARK( submit_chain )->UseRealTime();
+
+// The same chain as a pipeline, each stage is queued by the completion of the previous one
+static void pipe_chain( benchmark::State& state )
+{
+    be::task_pool pool( 1 );
+    for ( auto _ : state ) // NOLINT
+    {
+        auto pipe = pool | &first | &next | &next;
+        benchmark::DoNotOptimize( pipe.get() );
+    }
+}
+BENCHMARK( pipe_chain )->UseRealTime();
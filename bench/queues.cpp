@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <task_pool/pool.h>
+#include <task_pool/queues.h>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int operations = 1'000;
+
+struct payload
+{
+    std::uint64_t value[12]; // about the size of a task_proxy
+};
+
+be::locked_queue< payload >     s_locked;
+be::mpmc_queue< payload, 4096 > s_ring;
+} // namespace
+
+// Every thread pushing one value and popping one, so producers and consumers contend equally
+template< typename Queue >
+static void push_pop( benchmark::State& state, Queue& queue )
+{
+    payload value{};
+    for ( auto _ : state ) // NOLINT
+    {
+        for ( int i = 0; i < operations; ++i )
+        {
+            queue.push( value );
+            benchmark::DoNotOptimize( queue.try_pop( value ) );
+        }
+    }
+    state.SetItemsProcessed( state.iterations() * operations );
+}
+
+static void locked_queue( benchmark::State& state )
+{
+    push_pop( state, s_locked );
+}
+BENCHMARK( locked_queue )->ThreadRange( 1, 128 )->UseRealTime();
+
+static void mpmc_queue( benchmark::State& state )
+{
+    push_pop( state, s_ring );
+}
+BENCHMARK( mpmc_queue )->ThreadRange( 1, 128 )->UseRealTime();
+
+// Empty tasks per second submitted by range(0) external threads to a pool with one thread per
+// core, comparing the ready queue policies
+template< typename ReadyQueue >
+static void submit_from( benchmark::State& state )
+{
+    using pool_type          = be::task_pool_t< std::allocator< void >, ReadyQueue >;
+    constexpr int  tasks     = 1'000;
+    auto const     producers = static_cast< int >( state.range( 0 ) );
+    pool_type      pool( std::max( 1U, std::thread::hardware_concurrency() ) );
+    for ( auto _ : state ) // NOLINT
+    {
+        std::vector< std::thread > threads;
+        for ( int p = 0; p < producers; ++p )
+        {
+            threads.emplace_back( [&pool]() {
+                for ( int i = 0; i < tasks; ++i )
+                {
+                    auto future = pool.submit( std::launch::async, []() {} );
+                }
+            } );
+        }
+        for ( auto& thread : threads )
+        {
+            thread.join();
+        }
+        pool.wait();
+    }
+    state.SetItemsProcessed( state.iterations() * producers * tasks );
+}
+BENCHMARK_TEMPLATE( submit_from, be::locked_ready_queue )
+    ->RangeMultiplier( 2 )
+    ->Range( 1, 128 )
+    ->UseRealTime();
+BENCHMARK_TEMPLATE( submit_from, be::lock_free_ready_queue<> )
+    ->RangeMultiplier( 2 )
+    ->Range( 1, 128 )
+    ->UseRealTime();
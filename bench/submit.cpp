@@ -0,0 +1,73 @@
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <task_pool/futures.h>
+#include <task_pool/pool.h>
+#include <utility>
+
+namespace {
+// allocations made by the thread while s_counting is set, worker threads allocating at the same
+// time are left out
+thread_local std::size_t s_allocations = 0;
+thread_local bool        s_counting    = false;
+
+// Not inlined so GCC does not report the free as mismatching the operator new below
+#if defined( __GNUC__ )
+__attribute__( ( noinline ) )
+#endif
+void release( void* p ) noexcept
+{
+    std::free( p ); // NOLINT
+}
+} // namespace
+
+// Count every heap allocation made by submit so allocations done by the pool internals show up
+// as well as those made through the pool allocator
+void* operator new( std::size_t size )
+{
+    if ( s_counting )
+    {
+        ++s_allocations;
+    }
+    if ( void* p = std::malloc( size == 0 ? 1 : size ) ) // NOLINT
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete( void* p ) noexcept
+{
+    release( p );
+}
+void operator delete( void* p, std::size_t /*size*/ ) noexcept
+{
+    release( p );
+}
+
+template< std::size_t Size, template< typename > class Promise >
+static void submit_task( benchmark::State& state )
+{
+    be::task_pool            pool( 1 );
+    std::array< char, Size > payload{};
+    std::size_t              allocations = 0;
+    for ( auto _ : state ) // NOLINT
+    {
+        s_counting = true;
+        auto future =
+            pool.submit< Promise >( std::launch::async, [payload]() { return payload[0]; } );
+        s_counting = false;
+        allocations += std::exchange( s_allocations, 0U );
+        future.wait();
+    }
+    state.counters["allocs_per_submit"] =
+        benchmark::Counter( static_cast< double >( allocations ),
+                            benchmark::Counter::kAvgIterations );
+}
+BENCHMARK_TEMPLATE( submit_task, 8, std::promise );
+BENCHMARK_TEMPLATE( submit_task, 64, std::promise );
+BENCHMARK_TEMPLATE( submit_task, 512, std::promise );
+BENCHMARK_TEMPLATE( submit_task, 8, be::promise );
+BENCHMARK_TEMPLATE( submit_task, 64, be::promise );
+BENCHMARK_TEMPLATE( submit_task, 512, be::promise );
@@ -139,9 +139,21 @@ void tcp_server::serve_forever()
     {
         // blocking call on main
         auto socket = accept_connection();
+        // a client that disconnected cancels the stages of its pipeline that have not started
+        be::stop_source disconnected;
+        auto receive = [=]( int s ) mutable {
+            auto data = receive_data( s );
+            if ( data.second.empty() )
+            {
+                close_connection( s );
+                disconnected.request_stop();
+            }
+            return data;
+        };
         // offload response to detached pipeline
-        m_pool | [=] { return socket; }  
-               | &receive_data 
+        be::task_options const options( std::launch::async, disconnected.get_token() );
+        be::make_pipe( m_pool, options, [=] { return socket; } )
+               | receive
                | &parse_request 
                | &send_response
                | &close_connection
@@ -0,0 +1,326 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <task_pool/api.h>
+#include <task_pool/fallbacks.h>
+#include <task_pool/pool.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace be {
+
+namespace detail {
+/**
+ * @brief State shared between the calling thread and the pool tasks of one parallel algorithm
+ *
+ * @details Ranges that are split off are pushed onto `ranges_` and a pool task is submitted for
+ * each of them. Whoever gets to a range first, a pool task or the waiting caller, processes it.
+ * Pool tasks that find no range left return without touching anything but this state which they
+ * keep alive through their shared_ptr.
+ */
+struct parallel_state
+{
+    using range = std::pair< std::size_t, std::size_t >;
+
+    std::mutex              mutex_;
+    std::condition_variable changed_;
+    std::vector< range >    ranges_;
+    std::size_t             outstanding_ = 0; // split off ranges that have not finished
+    std::exception_ptr      error_;
+    std::atomic_bool        failed_{ false };
+
+    bool pop( range& next )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        if ( ranges_.empty() )
+        {
+            return false;
+        }
+        next = ranges_.back();
+        ranges_.pop_back();
+        return true;
+    }
+
+    void finish()
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        --outstanding_;
+        changed_.notify_all();
+    }
+
+    void fail( std::exception_ptr error )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        if ( !error_ )
+        {
+            error_ = std::move( error );
+        }
+        failed_ = true;
+    }
+};
+
+template< typename Allocator, typename ReadyQueue, typename Body >
+void parallel_run( task_pool_t< Allocator, ReadyQueue >&    pool,
+                   std::shared_ptr< parallel_state > const& state,
+                   Body&                                    body,
+                   std::size_t                              begin,
+                   std::size_t                              end,
+                   std::size_t                              grain );
+
+/**
+ * @brief Hands the upper part of a range to the pool
+ */
+template< typename Allocator, typename ReadyQueue, typename Body >
+void parallel_split( task_pool_t< Allocator, ReadyQueue >&    pool,
+                     std::shared_ptr< parallel_state > const& state,
+                     Body&                                    body,
+                     std::size_t                              begin,
+                     std::size_t                              end,
+                     std::size_t                              grain )
+{
+    {
+        std::unique_lock< std::mutex > lock( state->mutex_ );
+        state->ranges_.emplace_back( begin, end );
+        ++state->outstanding_;
+        state->changed_.notify_all();
+    }
+    pool.submit( std::launch::async, [&pool, state, &body, grain]() {
+        parallel_state::range next;
+        if ( state->pop( next ) )
+        {
+            parallel_run( pool, state, body, next.first, next.second, grain );
+            state->finish();
+        }
+    } );
+}
+
+/**
+ * @brief Processes a range using lazy binary splitting
+ *
+ * @details The range is processed grain elements at a time. Before each chunk the remainder is
+ * split in half if the pool has no queued tasks, meaning that there are threads looking for work.
+ * Splitting therefore follows the load of the pool rather than a precomputed partition.
+ */
+template< typename Allocator, typename ReadyQueue, typename Body >
+void parallel_run( task_pool_t< Allocator, ReadyQueue >&    pool,
+                   std::shared_ptr< parallel_state > const& state,
+                   Body&                                    body,
+                   std::size_t                              begin,
+                   std::size_t                              end,
+                   std::size_t const                        grain )
+{
+    try
+    {
+        while ( begin != end && !state->failed_ )
+        {
+            std::size_t const size = end - begin;
+            if ( size >= 2 * grain && pool.get_tasks_queued() == 0U )
+            {
+                std::size_t const middle = begin + size / 2;
+                parallel_split( pool, state, body, middle, end, grain );
+                end = middle;
+                continue;
+            }
+            std::size_t const chunk = std::min( size, grain );
+            body( begin, begin + chunk );
+            begin += chunk;
+        }
+    }
+    catch ( ... )
+    {
+        state->fail( std::current_exception() );
+    }
+}
+
+/**
+ * @brief Runs body over [0, count) in the pool with the calling thread taking part
+ *
+ * @details The caller processes the whole range itself, splitting off work for the pool as it
+ * goes, and then helps processing split off ranges until all have finished. The first exception
+ * thrown by body stops the remaining work and is rethrown.
+ */
+template< typename Allocator, typename ReadyQueue, typename Body >
+void parallel_invoke( task_pool_t< Allocator, ReadyQueue >& pool,
+                      std::size_t const                     count,
+                      std::size_t                           grain,
+                      Body&                                 body )
+{
+    if ( count == 0U )
+    {
+        return;
+    }
+    if ( grain == 0U )
+    {
+        // small enough for splitting to balance the load, large enough to amortize the checks
+        std::size_t const threads = std::max( pool.get_thread_count(), 1U );
+        grain                     = std::max< std::size_t >( count / ( threads * 64U ), 1U );
+    }
+    auto state = std::make_shared< parallel_state >();
+    parallel_run( pool, state, body, 0U, count, grain );
+    for ( ;; )
+    {
+        parallel_state::range next;
+        {
+            std::unique_lock< std::mutex > lock( state->mutex_ );
+            state->changed_.wait(
+                lock, [&]() { return state->outstanding_ == 0U || !state->ranges_.empty(); } );
+            if ( state->ranges_.empty() )
+            {
+                break;
+            }
+            next = state->ranges_.back();
+            state->ranges_.pop_back();
+        }
+        parallel_run( pool, state, body, next.first, next.second, grain );
+        state->finish();
+    }
+    if ( state->error_ )
+    {
+        std::rethrow_exception( state->error_ );
+    }
+}
+
+template< typename Iterator, std::enable_if_t< std::is_integral< Iterator >::value, bool > = true >
+Iterator parallel_element( Iterator first, std::size_t index )
+{
+    return static_cast< Iterator >( first + static_cast< Iterator >( index ) );
+}
+
+template< typename Iterator,
+          std::enable_if_t< !std::is_integral< Iterator >::value, bool > = true >
+decltype( auto ) parallel_element( Iterator first, std::size_t index )
+{
+    using difference_type = typename std::iterator_traits< Iterator >::difference_type;
+    return first[static_cast< difference_type >( index )];
+}
+
+template< typename Iterator,
+          std::enable_if_t< std::is_integral< Iterator >::value, bool > = true >
+std::size_t parallel_distance( Iterator first, Iterator last )
+{
+    return last > first ? static_cast< std::size_t >( last - first ) : 0U;
+}
+
+template< typename Iterator,
+          std::enable_if_t< !std::is_integral< Iterator >::value, bool > = true >
+std::size_t parallel_distance( Iterator first, Iterator last )
+{
+    using category = typename std::iterator_traits< Iterator >::iterator_category;
+    static_assert( std::is_base_of< std::random_access_iterator_tag, category >::value,
+                   "parallel algorithms require random access iterators" );
+    return static_cast< std::size_t >( std::distance( first, last ) );
+}
+} // namespace detail
+
+/**
+ * @brief Calls func for every element of [first, last) using the pool and the calling thread
+ *
+ * @details first and last may be random access iterators, in which case func is called with each
+ * element, or integers in which case func is called with each value in the range. Returns when
+ * every call has returned rethrowing the first exception thrown by func.
+ *
+ * @code{.cpp}
+ * be::parallel_for( pool, pixels.begin(), pixels.end(), []( pixel& p ) { p = invert( p ); } );
+ * be::parallel_for( pool, 0, height, [&]( int row ) { blur_row( image, row ); } );
+ * @endcode
+ *
+ * @param grain The number of elements processed between checks for idle threads, 0 to select one
+ * from the size of the range and the pool
+ */
+template< typename Allocator, typename ReadyQueue, typename Iterator, typename Func >
+void parallel_for( task_pool_t< Allocator, ReadyQueue >& pool,
+                   Iterator                              first,
+                   Iterator                              last,
+                   Func&&                                func,
+                   std::size_t                           grain = 0U )
+{
+    auto body = [&]( std::size_t begin, std::size_t end ) {
+        for ( std::size_t i = begin; i != end; ++i )
+        {
+            func( detail::parallel_element( first, i ) );
+        }
+    };
+    detail::parallel_invoke( pool, detail::parallel_distance( first, last ), grain, body );
+}
+
+/**
+ * @brief Assigns func applied to every element of [first, last) to the range starting at output
+ *
+ * @details Works like std::transform for random access iterators. Elements are assigned in no
+ * particular order. See parallel_for.
+ *
+ * @return An iterator one past the last element written
+ */
+template< typename Allocator,
+          typename ReadyQueue,
+          typename Iterator,
+          typename OutputIterator,
+          typename Func >
+OutputIterator parallel_transform( task_pool_t< Allocator, ReadyQueue >& pool,
+                                   Iterator                              first,
+                                   Iterator                              last,
+                                   OutputIterator                        output,
+                                   Func&&                                func,
+                                   std::size_t                           grain = 0U )
+{
+    auto body = [&]( std::size_t begin, std::size_t end ) {
+        for ( std::size_t i = begin; i != end; ++i )
+        {
+            detail::parallel_element( output, i ) = func( detail::parallel_element( first, i ) );
+        }
+    };
+    std::size_t const count = detail::parallel_distance( first, last );
+    detail::parallel_invoke( pool, count, grain, body );
+    using difference_type = typename std::iterator_traits< OutputIterator >::difference_type;
+    return std::next( output, static_cast< difference_type >( count ) );
+}
+
+/**
+ * @brief Combines init and every element of [first, last) using the associative operation reduce
+ *
+ * @details Partial results are computed for consecutive runs of elements and combined in the
+ * order of the elements so reduce does not have to be commutative. See parallel_for.
+ *
+ * @code{.cpp}
+ * auto total = be::parallel_reduce( pool, values.begin(), values.end(), 0.0, std::plus<>{} );
+ * @endcode
+ */
+template< typename Allocator, typename ReadyQueue, typename Iterator, typename T, typename Reduce >
+T parallel_reduce( task_pool_t< Allocator, ReadyQueue >& pool,
+                   Iterator                              first,
+                   Iterator                              last,
+                   T                                     init,
+                   Reduce&&                              reduce,
+                   std::size_t                           grain = 0U )
+{
+    std::mutex                                 mutex;
+    std::vector< std::pair< std::size_t, T > > partials;
+    auto                                       body = [&]( std::size_t begin, std::size_t end ) {
+        T partial( detail::parallel_element( first, begin ) );
+        for ( std::size_t i = begin + 1U; i != end; ++i )
+        {
+            partial = reduce( std::move( partial ), detail::parallel_element( first, i ) );
+        }
+        std::unique_lock< std::mutex > lock( mutex );
+        partials.emplace_back( begin, std::move( partial ) );
+    };
+    detail::parallel_invoke( pool, detail::parallel_distance( first, last ), grain, body );
+    std::sort( partials.begin(), partials.end(), []( auto const& lhs, auto const& rhs ) {
+        return lhs.first < rhs.first;
+    } );
+    for ( auto& partial : partials )
+    {
+        init = reduce( std::move( init ), std::move( partial.second ) );
+    }
+    return init;
+}
+
+} // namespace be
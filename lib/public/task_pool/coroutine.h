@@ -0,0 +1,645 @@
+#pragma once
+
+#if !defined( __cpp_impl_coroutine ) || !__has_include( <coroutine> )
+#    error "task_pool/coroutine.h requires C++20 coroutines"
+#endif
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <task_pool/api.h>
+#include <task_pool/futures.h>
+#include <task_pool/pool.h>
+#include <task_pool/stop_token.h>
+#include <task_pool/traits.h>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace be {
+
+template< typename T = void >
+class task;
+
+namespace detail {
+/**
+ * @brief Unit in which coroutine frames are allocated
+ */
+struct alignas( __STDCPP_DEFAULT_NEW_ALIGNMENT__ ) frame_block
+{
+    unsigned char bytes[__STDCPP_DEFAULT_NEW_ALIGNMENT__]; // NOLINT (c-arrays)
+};
+
+/**
+ * @brief Stored behind a coroutine frame so operator delete, which only gets the size, can return
+ * the frame to the allocator it came from
+ */
+template< typename BlockAllocator >
+struct frame_trailer
+{
+    void ( *deallocate )( void*, std::size_t ); // first so it is found without knowing the type
+    BlockAllocator alloc;
+};
+
+constexpr std::size_t frame_offset( std::size_t size ) noexcept
+{
+    return ( size + sizeof( frame_block ) - 1U ) / sizeof( frame_block ) * sizeof( frame_block );
+}
+
+template< typename BlockAllocator >
+constexpr std::size_t frame_blocks( std::size_t size ) noexcept
+{
+    return ( frame_offset( size ) + sizeof( frame_trailer< BlockAllocator > ) +
+             sizeof( frame_block ) - 1U ) /
+           sizeof( frame_block );
+}
+
+template< typename BlockAllocator >
+void deallocate_frame( void* frame, std::size_t size ) noexcept
+{
+    using trailer = frame_trailer< BlockAllocator >;
+    using traits  = std::allocator_traits< BlockAllocator >;
+    auto* stored  = std::launder(
+        reinterpret_cast< trailer* >( static_cast< unsigned char* >( frame ) + // NOLINT
+                                      frame_offset( size ) ) );
+    BlockAllocator alloc( std::move( stored->alloc ) );
+    stored->~trailer();
+    traits::deallocate(
+        alloc, static_cast< frame_block* >( frame ), frame_blocks< BlockAllocator >( size ) );
+}
+
+template< typename Allocator >
+void* allocate_frame( Allocator const& allocator, std::size_t size )
+{
+    using block_allocator =
+        typename std::allocator_traits< Allocator >::template rebind_alloc< frame_block >;
+    using trailer = frame_trailer< block_allocator >;
+    using traits  = std::allocator_traits< block_allocator >;
+    static_assert( alignof( trailer ) <= alignof( frame_block ),
+                   "the allocator is over-aligned for coroutine frames" );
+    block_allocator alloc( allocator );
+    frame_block*    frame =
+        std::to_address( traits::allocate( alloc, frame_blocks< block_allocator >( size ) ) );
+    ::new ( reinterpret_cast< unsigned char* >( frame ) + frame_offset( size ) ) // NOLINT
+        trailer{ &deallocate_frame< block_allocator >, std::move( alloc ) };
+    return frame;
+}
+
+/**
+ * @brief Returns a frame to the allocator recorded behind it by allocate_frame
+ */
+inline void free_frame( void* frame, std::size_t size ) noexcept
+{
+    using deallocate_function = void ( * )( void*, std::size_t );
+    auto* stored              = std::launder( reinterpret_cast< deallocate_function* >( // NOLINT
+        static_cast< unsigned char* >( frame ) + frame_offset( size ) ) );
+    ( *stored )( frame, size );
+}
+
+template< typename Allocator, typename ReadyQueue, typename... Args >
+Allocator frame_allocator( task_pool_t< Allocator, ReadyQueue >& pool, Args const&... /*args*/ )
+{
+    return pool.get_allocator();
+}
+
+template< typename Allocator, typename... Args >
+Allocator frame_allocator( std::allocator_arg_t /*tag*/,
+                           Allocator const& alloc,
+                           Args const&... /*args*/ )
+{
+    return alloc;
+}
+
+template< typename... Args >
+std::allocator< void > frame_allocator( Args const&... /*args*/ )
+{
+    return {};
+}
+
+class coroutine_promise_base;
+
+/**
+ * @brief Owns a suspended coroutine from the moment it is queued on a pool until it is resumed
+ *
+ * @details A queued task that is destroyed without running, because the pool was aborted or
+ * destroyed or drop_oldest evicted it, destroys the be::spawn coroutine that is suspended on this
+ * coroutine, which breaks the promise of the future it returned. Other coroutines belong to
+ * whoever holds their be::task or handle and are left to them.
+ */
+class suspended_coroutine
+{
+public:
+    suspended_coroutine( std::coroutine_handle<> handle, coroutine_promise_base* promise ) noexcept
+        : handle_( handle )
+        , promise_( promise )
+    {
+    }
+    ~suspended_coroutine()
+    {
+        if ( handle_ )
+        {
+            destroy();
+        }
+    }
+    suspended_coroutine( suspended_coroutine const& ) = delete;
+    suspended_coroutine& operator=( suspended_coroutine const& ) = delete;
+    suspended_coroutine( suspended_coroutine&& other ) noexcept
+        : handle_( std::exchange( other.handle_, {} ) )
+        , promise_( other.promise_ )
+    {
+    }
+    suspended_coroutine& operator=( suspended_coroutine&& ) = delete;
+
+    void resume() { std::exchange( handle_, {} ).resume(); }
+
+private:
+    void destroy() noexcept;
+
+    std::coroutine_handle<> handle_;
+    coroutine_promise_base* promise_; // nullptr for coroutines that are not of the library
+};
+
+/**
+ * @brief Queues the resumption of a coroutine on the pool it was last scheduled on
+ */
+struct coroutine_scheduler
+{
+    void ( *post )( void*, suspended_coroutine ) = nullptr;
+    void* pool                                   = nullptr;
+
+    explicit operator bool() const noexcept { return post != nullptr; }
+    void     operator()( suspended_coroutine coroutine ) const
+    {
+        post( pool, std::move( coroutine ) );
+    }
+};
+
+/**
+ * @brief Resumes a coroutine awaiting a future that can notify once the future is ready
+ *
+ * @details The continuation of the future queues the coroutine on the pool it runs on instead of
+ * resuming it since the coroutine may destroy the future, which waits for the continuation to
+ * return. Coroutines that never were scheduled on a pool block on the future instead.
+ */
+template< typename Future >
+class future_awaiter
+{
+public:
+    future_awaiter( Future&                 future,
+                    coroutine_scheduler     scheduler,
+                    coroutine_promise_base* promise ) noexcept
+        : future_( future )
+        , scheduler_( scheduler )
+        , promise_( promise )
+    {
+    }
+
+    bool await_ready() const
+    {
+        return future_.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready;
+    }
+
+    bool await_suspend( std::coroutine_handle<> awaiting )
+    {
+        if ( !scheduler_ )
+        {
+            future_.wait();
+            return false;
+        }
+        awaiting_ = awaiting;
+        return future_.set_continuation( continuation{ &future_awaiter::ready, this } );
+    }
+
+    decltype( auto ) await_resume() { return future_.get(); }
+
+private:
+    static void ready( void* self )
+    {
+        auto* awaiter = static_cast< future_awaiter* >( self );
+        awaiter->scheduler_( suspended_coroutine( awaiter->awaiting_, awaiter->promise_ ) );
+    }
+
+    Future&                 future_;
+    coroutine_scheduler     scheduler_;
+    coroutine_promise_base* promise_;
+    std::coroutine_handle<> awaiting_;
+};
+
+/**
+ * @brief Scheduling shared by the coroutine types of the library
+ */
+class coroutine_promise_base
+{
+public:
+    /**
+     * @brief Futures that can notify resume the coroutine through the pool instead of blocking
+     */
+    template< typename Awaitable >
+    decltype( auto ) await_transform( Awaitable&& awaitable ) noexcept
+    {
+        if constexpr ( future_api::is_notifying< std::decay_t< Awaitable > >::value )
+        {
+            return future_awaiter< std::remove_reference_t< Awaitable > >(
+                awaitable, scheduler_, this );
+        }
+        else
+        {
+            return std::forward< Awaitable >( awaitable );
+        }
+    }
+
+    coroutine_scheduler     scheduler_;             // pool the coroutine was last scheduled on
+    std::coroutine_handle<> continuation_;          // awaiting a be::task
+    coroutine_promise_base* parent_   = nullptr;    // of continuation_ if it is of the library
+    bool                    detached_ = false;      // started by be::spawn
+};
+
+inline void suspended_coroutine::destroy() noexcept
+{
+    // destroying the outermost frame destroys the be::task of each frame it awaits
+    std::coroutine_handle<> frame   = handle_;
+    coroutine_promise_base* promise = promise_;
+    while ( promise != nullptr && promise->parent_ != nullptr )
+    {
+        frame   = promise->continuation_;
+        promise = promise->parent_;
+    }
+    if ( promise != nullptr && promise->detached_ )
+    {
+        frame.destroy();
+    }
+}
+
+/**
+ * @brief Promise of a coroutine with the parameters Args allocating its frame through the
+ * allocator returned by frame_allocator
+ *
+ * @details Frames of coroutines whose first parameter is a task_pool_t are allocated through the
+ * allocator of the pool, those taking `std::allocator_arg_t, Allocator` first through that
+ * allocator and all others through std::allocator. The parameters are part of the promise rather
+ * than of a template operator new since GCC reports the usual operator delete as mismatching
+ * those.
+ */
+template< typename Promise, typename... Args >
+class frame_promise : public Promise
+{
+public:
+    static void* operator new( std::size_t size, Args const&... args )
+    {
+        return allocate_frame( frame_allocator( args... ), size );
+    }
+
+    static void operator delete( void* frame, std::size_t size ) noexcept
+    {
+        free_frame( frame, size );
+    }
+
+    auto get_return_object() noexcept
+    {
+        return Promise::get_return_object(
+            std::coroutine_handle< frame_promise >::from_promise( *this ) );
+    }
+};
+
+/**
+ * @brief Resumes the coroutine awaiting a finished be::task
+ */
+struct final_awaiter
+{
+    bool await_ready() const noexcept { return false; }
+
+    template< typename Promise >
+    std::coroutine_handle<>
+    await_suspend( std::coroutine_handle< Promise > finished ) const noexcept
+    {
+        auto next = finished.promise().continuation_;
+        return next ? next : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Result of a be::task
+ */
+template< typename T >
+class task_promise : public coroutine_promise_base
+{
+public:
+    task< T > get_return_object( std::coroutine_handle<> handle ) noexcept;
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    final_awaiter        final_suspend() const noexcept { return {}; }
+
+    template< typename U, std::enable_if_t< std::is_convertible_v< U&&, T >, bool > = true >
+    void return_value( U&& value )
+    {
+        result_.template emplace< 1 >( std::forward< U >( value ) );
+    }
+    void unhandled_exception() noexcept
+    {
+        result_.template emplace< 2 >( std::current_exception() );
+    }
+
+    T result()
+    {
+        if ( result_.index() == 2U )
+        {
+            std::rethrow_exception( std::get< 2 >( result_ ) );
+        }
+        return std::move( std::get< 1 >( result_ ) );
+    }
+
+private:
+    std::variant< std::monostate, T, std::exception_ptr > result_;
+};
+
+template<>
+class task_promise< void > : public coroutine_promise_base
+{
+public:
+    task< void > get_return_object( std::coroutine_handle<> handle ) noexcept;
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    final_awaiter        final_suspend() const noexcept { return {}; }
+
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+    void result()
+    {
+        if ( error_ )
+        {
+            std::rethrow_exception( error_ );
+        }
+    }
+
+private:
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief Coroutine started on its own that destroys itself once it completes
+ */
+struct detached_coroutine
+{
+    struct promise : coroutine_promise_base
+    {
+        promise() noexcept { detached_ = true; }
+
+        detached_coroutine get_return_object( std::coroutine_handle<> /*handle*/ ) noexcept
+        {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void               return_void() noexcept {}
+        [[noreturn]] void  unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+} // namespace detail
+
+/**
+ * @brief Coroutine producing a T that starts once it is awaited
+ *
+ * @details Awaiting a task runs it on the awaiting thread until it suspends, its result or
+ * exception is returned from co_await and the awaiting coroutine is resumed where the task
+ * completes. Tasks inherit the pool of the coroutine awaiting them so futures they await resume
+ * them on that pool. be::spawn runs a task on a pool from code that is not a coroutine.
+ *
+ * @code{.cpp}
+ * be::task< std::string > render( be::task_pool& pool, request req )
+ * {
+ *     co_await pool.schedule();
+ *     auto profile = co_await pool.submit< be::promise >( std::launch::async, &load_profile, req );
+ *     co_return format( profile );
+ * }
+ * @endcode
+ */
+template< typename T >
+class [[nodiscard]] task
+{
+    static_assert( !std::is_reference_v< T >,
+                   "tasks return values, use a pointer or std::reference_wrapper for references" );
+
+public:
+    using value_type = T;
+
+    task() noexcept = default;
+    task( std::coroutine_handle<> handle, detail::task_promise< T >& promise ) noexcept
+        : handle_( handle )
+        , promise_( &promise )
+    {
+    }
+    ~task()
+    {
+        if ( handle_ )
+        {
+            handle_.destroy();
+        }
+    }
+    task( task const& ) = delete;
+    task& operator=( task const& ) = delete;
+    task( task&& other ) noexcept
+        : handle_( std::exchange( other.handle_, {} ) )
+        , promise_( std::exchange( other.promise_, nullptr ) )
+    {
+    }
+    task& operator=( task&& other ) noexcept
+    {
+        if ( this != &other )
+        {
+            if ( handle_ )
+            {
+                handle_.destroy();
+            }
+            handle_  = std::exchange( other.handle_, {} );
+            promise_ = std::exchange( other.promise_, nullptr );
+        }
+        return *this;
+    }
+
+    bool valid() const noexcept { return static_cast< bool >( handle_ ); }
+
+    auto operator co_await() const noexcept { return awaiter{ handle_, promise_ }; }
+
+private:
+    struct awaiter
+    {
+        std::coroutine_handle<>      handle_;
+        detail::task_promise< T >* promise_;
+
+        bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+        template< typename Promise >
+        std::coroutine_handle<> await_suspend( std::coroutine_handle< Promise > awaiting ) noexcept
+        {
+            promise_->parent_ = nullptr;
+            if constexpr ( std::is_base_of_v< detail::coroutine_promise_base, Promise > )
+            {
+                promise_->scheduler_ = awaiting.promise().scheduler_;
+                promise_->parent_    = &awaiting.promise();
+            }
+            promise_->continuation_ = awaiting;
+            return handle_;
+        }
+
+        T await_resume()
+        {
+            if ( !handle_ )
+            {
+                throw std::future_error( std::future_errc::no_state );
+            }
+            return promise_->result();
+        }
+    };
+
+    std::coroutine_handle<>      handle_;
+    detail::task_promise< T >* promise_ = nullptr;
+};
+
+namespace detail {
+template< typename T >
+task< T > task_promise< T >::get_return_object( std::coroutine_handle<> handle ) noexcept
+{
+    return task< T >( handle, *this );
+}
+
+inline task< void > task_promise< void >::get_return_object( std::coroutine_handle<> handle ) noexcept
+{
+    return task< void >( handle, *this );
+}
+} // namespace detail
+
+/**
+ * @brief Awaitable returned by task_pool_t::schedule resuming the coroutine on a thread of the
+ * pool
+ *
+ * @details The coroutine is queued like a task with the given options, if their stop_token fired
+ * before it was resumed co_await throws be::task_cancelled, be::deadline_exceeded if their
+ * deadline passed. Futures awaited afterwards resume the
+ * coroutine on the same pool. Coroutines queued on a pool that is aborted or destroyed are never
+ * resumed, those started by be::spawn are destroyed and their future reports a broken promise.
+ */
+template< typename Pool >
+class schedule_awaiter
+{
+public:
+    schedule_awaiter( Pool& pool, task_options options ) noexcept
+        : pool_( pool )
+        , options_( std::move( options ) )
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    template< typename Promise >
+    void await_suspend( std::coroutine_handle< Promise > awaiting )
+    {
+        detail::coroutine_promise_base* promise = nullptr;
+        if constexpr ( std::is_base_of_v< detail::coroutine_promise_base, Promise > )
+        {
+            awaiting.promise().scheduler_ = scheduler( pool_ );
+            promise                       = &awaiting.promise();
+        }
+        // the coroutine may run before post returns so this is not touched afterwards
+        pool_.post( std::move( options_ ),
+                    [this, coroutine = detail::suspended_coroutine( awaiting, promise )]() mutable {
+                        try
+                        {
+                            Pool::pool_runtime::throw_if_cancelled();
+                        }
+                        catch ( ... )
+                        {
+                            cancelled_ = std::current_exception();
+                        }
+                        coroutine.resume();
+                    } );
+    }
+
+    void await_resume() const
+    {
+        if ( cancelled_ )
+        {
+            std::rethrow_exception( cancelled_ );
+        }
+    }
+
+    static detail::coroutine_scheduler scheduler( Pool& pool ) noexcept
+    {
+        return { []( void* self, detail::suspended_coroutine coroutine ) {
+                    static_cast< Pool* >( self )->post(
+                        task_options{},
+                        [coroutine = std::move( coroutine )]() mutable { coroutine.resume(); } );
+                },
+                 &pool };
+    }
+
+private:
+    Pool&              pool_;
+    task_options       options_;
+    std::exception_ptr cancelled_;
+};
+
+namespace detail {
+template< typename Pool, typename T >
+detached_coroutine run_detached( Pool& pool, task< T > work, be::promise< T > promise )
+{
+    try
+    {
+        co_await pool.schedule();
+        if constexpr ( std::is_void_v< T > )
+        {
+            co_await work;
+            promise.set_value();
+        }
+        else
+        {
+            promise.set_value( co_await work );
+        }
+    }
+    catch ( ... )
+    {
+        promise.set_exception( std::current_exception() );
+    }
+}
+} // namespace detail
+
+/**
+ * @brief Runs a task on a thread of the pool returning a future of its result
+ *
+ * @code{.cpp}
+ * auto reply = be::spawn( pool, render( pool, req ) );
+ * send( reply.get() );
+ * @endcode
+ */
+template< typename Allocator, typename ReadyQueue, typename T >
+be::future< T > spawn( task_pool_t< Allocator, ReadyQueue >& pool, task< T > work )
+{
+    be::promise< T > promise( std::allocator_arg_t{}, pool.get_allocator() );
+    auto             result = promise.get_future();
+    detail::run_detached( pool, std::move( work ), std::move( promise ) );
+    return result;
+}
+
+} // namespace be
+
+namespace std {
+/**
+ * @brief Coroutines of the library get a promise for their parameters, see
+ * be::detail::frame_promise
+ */
+template< typename T, typename... Args >
+struct coroutine_traits< be::task< T >, Args... >
+{
+    using promise_type = be::detail::frame_promise< be::detail::task_promise< T >, Args... >;
+};
+
+template< typename... Args >
+struct coroutine_traits< be::detail::detached_coroutine, Args... >
+{
+    using promise_type =
+        be::detail::frame_promise< be::detail::detached_coroutine::promise, Args... >;
+};
+} // namespace std
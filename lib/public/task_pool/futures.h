@@ -0,0 +1,1113 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <task_pool/api.h>
+#include <task_pool/fallbacks.h>
+#include <task_pool/traits.h>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace be {
+
+namespace detail {
+/**
+ * @brief State shared between a notifying_promise and its future holding the continuation that
+ * should be invoked when the promise is satisfied
+ *
+ * @details The continuation is invoked with the mutex held so a future that is being destroyed
+ * can never have its continuation context freed from under a running continuation. Continuations
+ * must therefore never block on, or destroy, the future that they where registered on.
+ */
+struct continuation_slot
+{
+    std::mutex   mutex_;
+    bool         ready_ = false;
+    continuation next_  = {};
+
+    bool set( continuation const& next )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        if ( ready_ )
+        {
+            return false;
+        }
+        next_ = next;
+        return true;
+    }
+
+    void reset()
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        next_ = continuation{};
+    }
+
+    void fire()
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        ready_ = true;
+        if ( next_ )
+        {
+            continuation next = next_;
+            next_             = continuation{};
+            next();
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief A std::future that can notify a single continuation once it becomes ready
+ *
+ * @details notifying_future objects are returned from notifying_promise::get_future and may be
+ * used as any std::future. When passed as lazy arguments to `task_pool::submit` the pool registers
+ * a continuation instead of polling the future so the task is queued as soon as the last of its
+ * arguments are ready.
+ */
+template< typename T >
+class notifying_future : public std::future< T >
+{
+public:
+    notifying_future() noexcept = default;
+    notifying_future( std::future< T >&& base, std::shared_ptr< detail::continuation_slot > slot )
+        : std::future< T >( std::move( base ) )
+        , slot_( std::move( slot ) )
+    {
+    }
+    ~notifying_future()
+    {
+        if ( slot_ )
+        {
+            slot_->reset();
+        }
+    }
+    notifying_future( notifying_future const& ) = delete;
+    notifying_future& operator=( notifying_future const& ) = delete;
+    notifying_future( notifying_future&& other ) noexcept
+        : std::future< T >( std::move( other ) )
+        , slot_( std::move( other.slot_ ) )
+    {
+    }
+    notifying_future& operator=( notifying_future&& other ) noexcept
+    {
+        if ( slot_ )
+        {
+            slot_->reset();
+        }
+        std::future< T >::operator=( std::move( other ) );
+        slot_ = std::move( other.slot_ );
+        return *this;
+    }
+
+    /**
+     * @brief Registers a continuation to invoke once the future is ready replacing any previous
+     * continuation
+     *
+     * @return false if the future is already ready in which case the continuation is not stored
+     */
+    bool set_continuation( continuation const& next )
+    {
+        return slot_ && slot_->set( next );
+    }
+
+private:
+    std::shared_ptr< detail::continuation_slot > slot_;
+};
+
+namespace detail {
+/**
+ * @brief Members shared by all notifying_promise specializations
+ */
+template< typename T >
+class notifying_promise_base
+{
+public:
+    notifying_promise_base()
+        : slot_( std::make_shared< continuation_slot >() )
+    {
+    }
+    template< typename Allocator >
+    notifying_promise_base( std::allocator_arg_t tag, Allocator const& alloc )
+        : promise_( tag, alloc )
+        , slot_( std::allocate_shared< continuation_slot >( alloc ) )
+    {
+    }
+    ~notifying_promise_base() { abandon(); }
+    notifying_promise_base( notifying_promise_base const& ) = delete;
+    notifying_promise_base& operator=( notifying_promise_base const& ) = delete;
+    notifying_promise_base( notifying_promise_base&& other ) noexcept
+        : promise_( std::move( other.promise_ ) )
+        , slot_( std::move( other.slot_ ) )
+        , satisfied_( other.satisfied_ )
+    {
+    }
+    notifying_promise_base& operator=( notifying_promise_base&& other ) noexcept
+    {
+        abandon();
+        promise_   = std::move( other.promise_ );
+        slot_      = std::move( other.slot_ );
+        satisfied_ = other.satisfied_;
+        return *this;
+    }
+
+    notifying_future< T > get_future() { return { promise_.get_future(), slot_ }; }
+
+    void set_exception( std::exception_ptr error )
+    {
+        promise_.set_exception( std::move( error ) );
+        notify();
+    }
+
+protected:
+    void abandon() noexcept
+    {
+        if ( slot_ && !satisfied_ )
+        {
+            // abandon the shared state so the future reports a broken promise before the
+            // continuation is told about it
+            promise_ = std::promise< T >();
+            slot_->fire();
+        }
+    }
+
+    void notify()
+    {
+        satisfied_ = true;
+        slot_->fire();
+    }
+
+    std::promise< T >                    promise_;
+    std::shared_ptr< continuation_slot > slot_;
+    bool                                 satisfied_ = false;
+};
+} // namespace detail
+
+/**
+ * @brief A std::promise that notifies the continuation registered on its notifying_future when
+ * it is satisfied or abandoned
+ *
+ * @details Pipelines use notifying_promise for every stage so that stages are queued directly by
+ * the completion of their upstream stage. It is also the default promise of submit.
+ *
+ * @code{.cpp}
+ * auto data   = pool.submit( std::launch::async, &make_data );
+ * auto result = pool.submit( std::launch::async, &process_data, std::move( data ) );
+ * @endcode
+ */
+template< typename T >
+class notifying_promise : public detail::notifying_promise_base< T >
+{
+public:
+    using detail::notifying_promise_base< T >::notifying_promise_base;
+
+    void set_value( T const& value )
+    {
+        this->promise_.set_value( value );
+        this->notify();
+    }
+    void set_value( T&& value )
+    {
+        this->promise_.set_value( std::move( value ) );
+        this->notify();
+    }
+};
+
+template< typename T >
+class notifying_promise< T& > : public detail::notifying_promise_base< T& >
+{
+public:
+    using detail::notifying_promise_base< T& >::notifying_promise_base;
+
+    void set_value( T& value )
+    {
+        this->promise_.set_value( value );
+        this->notify();
+    }
+};
+
+template<>
+class notifying_promise< void > : public detail::notifying_promise_base< void >
+{
+public:
+    using detail::notifying_promise_base< void >::notifying_promise_base;
+
+    void set_value()
+    {
+        this->promise_.set_value();
+        this->notify();
+    }
+};
+
+namespace detail {
+/**
+ * @brief Blocks the calling thread while word holds the expected value
+ *
+ * @details Uses futex on linux and a table of condition variables elsewhere. Spurious wakeups are
+ * possible so callers must check the value again after returning.
+ */
+TASKPOOL_API void atomic_wait( std::atomic< std::uint32_t >& word, std::uint32_t expected );
+
+/**
+ * @brief Blocks the calling thread while word holds the expected value or until timeout has passed
+ */
+TASKPOOL_API void atomic_wait_for( std::atomic< std::uint32_t >& word,
+                                   std::uint32_t                 expected,
+                                   std::chrono::nanoseconds      timeout );
+
+/**
+ * @brief Wakes every thread blocked on word in atomic_wait or atomic_wait_for
+ */
+TASKPOOL_API void atomic_notify_all( std::atomic< std::uint32_t >& word );
+
+/**
+ * @brief Runs queued tasks for a thread that waits on a be::future
+ *
+ * @details Threads of a task_pool install one so that a task waiting for another task runs queued
+ * tasks instead of blocking its thread. Without tasks to run the waiting thread sleeps for
+ * interval before looking again.
+ */
+struct task_helper
+{
+    bool ( *run_task )( void* ) = nullptr; // runs one task, returns false if there was none
+    void*                    context  = nullptr;
+    std::chrono::nanoseconds interval = std::chrono::nanoseconds::zero();
+};
+
+/**
+ * @brief Returns the task_helper of the calling thread, without a run_task function if the thread
+ * has none
+ */
+TASKPOOL_API task_helper& this_thread_helper() noexcept;
+
+/**
+ * @brief Storage for the value of a future_state
+ */
+template< typename T >
+class future_value
+{
+public:
+    future_value() noexcept {} // NOLINT
+    ~future_value()
+    {
+        if ( constructed_ )
+        {
+            get().~T();
+        }
+    }
+    future_value( future_value const& ) = delete;
+    future_value& operator=( future_value const& ) = delete;
+    future_value( future_value&& )                 = delete;
+    future_value& operator=( future_value&& ) = delete;
+
+    template< typename... Args >
+    void emplace( Args&&... args )
+    {
+        ::new ( static_cast< void* >( &storage_ ) ) T( std::forward< Args >( args )... );
+        constructed_ = true;
+    }
+    T    take() { return std::move( get() ); }
+    void forward( std::promise< T >& promise ) { promise.set_value( take() ); }
+
+private:
+    T& get() noexcept { return *reinterpret_cast< T* >( &storage_ ); } // NOLINT
+
+    typename std::aligned_storage< sizeof( T ), alignof( T ) >::type storage_;
+    bool                                                             constructed_ = false;
+};
+
+template< typename T >
+class future_value< T& >
+{
+public:
+    void emplace( T& value ) noexcept { value_ = &value; }
+    T&   take() const noexcept { return *value_; }
+    void forward( std::promise< T& >& promise ) const { promise.set_value( *value_ ); }
+
+private:
+    T* value_ = nullptr;
+};
+
+template<>
+class future_value< void >
+{
+public:
+    static void emplace() noexcept {}
+    static void take() noexcept {}
+    static void forward( std::promise< void >& promise ) { promise.set_value(); }
+};
+
+/**
+ * @brief Shared state of be::promise and be::future
+ *
+ * @details The state is a single allocation made with the allocator given to the promise. All
+ * synchronization goes through one atomic status word that also serves as the futex that waiting
+ * threads block on, so the state carries no mutex or condition variable.
+ *
+ * A continuation registered by the future is invoked by the thread satisfying the promise. While it
+ * runs the state is marked as firing and a future that is being destroyed or given a new
+ * continuation waits for the continuation to return. Continuations must therefore never destroy
+ * the future that they where registered on.
+ */
+template< typename T >
+class future_state
+{
+public:
+    enum : std::uint32_t
+    {
+        ready            = 1U,
+        has_continuation = 2U,
+        firing           = 4U,
+        has_waiters      = 8U,
+    };
+
+    template< typename Allocator >
+    static future_state* create( Allocator const& alloc )
+    {
+        struct TASKPOOL_HIDDEN state_with_allocator : future_state
+        {
+            using StateAllocator = typename std::allocator_traits<
+                Allocator >::template rebind_alloc< state_with_allocator >;
+            using traits = std::allocator_traits< StateAllocator >;
+
+            StateAllocator alloc_;
+
+            explicit state_with_allocator( StateAllocator const& a )
+                : future_state( []( future_state* x ) {
+                    auto*          self = static_cast< state_with_allocator* >( x );
+                    StateAllocator allocator( self->alloc_ );
+                    traits::destroy( allocator, self );
+                    traits::deallocate( allocator, self, 1 );
+                } )
+                , alloc_( a )
+            {
+            }
+        };
+        using StateAllocator = typename state_with_allocator::StateAllocator;
+        using traits         = typename state_with_allocator::traits;
+        StateAllocator        state_allocator( alloc );
+        state_with_allocator* state = traits::allocate( state_allocator, 1 );
+        try
+        {
+            traits::construct( state_allocator, state, state_allocator );
+        }
+        catch ( ... )
+        {
+            traits::deallocate( state_allocator, state, 1 );
+            throw;
+        }
+        return state;
+    }
+
+    future_state( future_state const& ) = delete;
+    future_state& operator=( future_state const& ) = delete;
+    future_state( future_state&& )                 = delete;
+    future_state& operator=( future_state&& ) = delete;
+
+    void acquire() noexcept { references_.fetch_add( 1U, std::memory_order_relaxed ); }
+    void release() noexcept
+    {
+        if ( references_.fetch_sub( 1U, std::memory_order_acq_rel ) == 1U )
+        {
+            destroy_( this );
+        }
+    }
+
+    bool is_ready() const noexcept
+    {
+        return ( status_.load( std::memory_order_acquire ) & ready ) != 0U;
+    }
+
+    template< typename... Args >
+    void set_value( Args&&... args )
+    {
+        value_.emplace( std::forward< Args >( args )... );
+        publish();
+    }
+
+    void set_exception( std::exception_ptr error )
+    {
+        error_ = std::move( error );
+        publish();
+    }
+
+    T take()
+    {
+        if ( error_ )
+        {
+            std::rethrow_exception( error_ );
+        }
+        return value_.take();
+    }
+
+    void forward( std::promise< T >& promise )
+    {
+        if ( error_ )
+        {
+            promise.set_exception( error_ );
+        }
+        else
+        {
+            value_.forward( promise );
+        }
+    }
+
+    /**
+     * @brief Blocks until the state is ready, running tasks through the task_helper of the calling
+     * thread meanwhile
+     */
+    void wait()
+    {
+        std::uint32_t status = status_.load( std::memory_order_acquire );
+        if ( ( status & ready ) != 0U )
+        {
+            return;
+        }
+        task_helper const helper = this_thread_helper();
+        while ( ( status & ready ) == 0U )
+        {
+            if ( helper.run_task != nullptr && helper.run_task( helper.context ) )
+            {
+                status = status_.load( std::memory_order_acquire );
+                continue;
+            }
+            if ( mark_waiting( status ) )
+            {
+                if ( helper.run_task != nullptr )
+                {
+                    atomic_wait_for( status_, status, helper.interval );
+                }
+                else
+                {
+                    atomic_wait( status_, status );
+                }
+            }
+            status = status_.load( std::memory_order_acquire );
+        }
+    }
+
+    bool wait_for( std::chrono::nanoseconds timeout )
+    {
+        auto const    deadline = std::chrono::steady_clock::now() + timeout;
+        std::uint32_t status   = status_.load( std::memory_order_acquire );
+        while ( ( status & ready ) == 0U )
+        {
+            auto const remaining = deadline - std::chrono::steady_clock::now();
+            if ( remaining <= std::chrono::nanoseconds::zero() )
+            {
+                return false;
+            }
+            if ( mark_waiting( status ) )
+            {
+                atomic_wait_for( status_, status, remaining );
+            }
+            status = status_.load( std::memory_order_acquire );
+        }
+        return true;
+    }
+
+    /**
+     * @brief Stores a continuation to invoke when the state becomes ready
+     *
+     * @return false if the state is already ready in which case the continuation is not stored
+     */
+    bool attach( continuation const& next )
+    {
+        detach();
+        std::uint32_t status = status_.load( std::memory_order_acquire );
+        if ( ( status & ready ) != 0U )
+        {
+            return false;
+        }
+        next_ = next;
+        while ( !status_.compare_exchange_weak(
+            status, status | has_continuation, std::memory_order_acq_rel ) )
+        {
+            if ( ( status & ready ) != 0U )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Removes any stored continuation waiting for it to return if it is running
+     */
+    void detach() noexcept
+    {
+        std::uint32_t status = status_.load( std::memory_order_acquire );
+        for ( ;; )
+        {
+            if ( ( status & has_continuation ) != 0U )
+            {
+                if ( status_.compare_exchange_weak(
+                         status, status & ~has_continuation, std::memory_order_acq_rel ) )
+                {
+                    return;
+                }
+            }
+            else if ( ( status & firing ) != 0U )
+            {
+                std::this_thread::yield();
+                status = status_.load( std::memory_order_acquire );
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    bool retrieved_ = false;
+
+protected:
+    explicit future_state( void ( *destroy )( future_state* ) ) noexcept
+        : destroy_( destroy )
+    {
+    }
+    ~future_state() = default;
+
+private:
+    /**
+     * @brief Flags that a thread is about to block on the status
+     *
+     * @return false if the status changed before the flag could be set
+     */
+    bool mark_waiting( std::uint32_t& status ) noexcept
+    {
+        if ( ( status & has_waiters ) != 0U )
+        {
+            return true;
+        }
+        std::uint32_t const waiting = status | has_waiters;
+        if ( status_.compare_exchange_strong( status, waiting, std::memory_order_acq_rel ) )
+        {
+            status = waiting;
+            return true;
+        }
+        return false;
+    }
+
+    void publish()
+    {
+        std::uint32_t status = status_.load( std::memory_order_relaxed );
+        std::uint32_t next   = 0U;
+        do
+        {
+            next = status | ready;
+            if ( ( status & has_continuation ) != 0U )
+            {
+                next = ( next & ~has_continuation ) | firing;
+            }
+        } while ( !status_.compare_exchange_weak( status, next, std::memory_order_acq_rel ) );
+
+        if ( ( status & has_waiters ) != 0U )
+        {
+            atomic_notify_all( status_ );
+        }
+        if ( ( status & has_continuation ) != 0U )
+        {
+            continuation const fire = next_;
+            fire();
+            status_.fetch_and( ~static_cast< std::uint32_t >( firing ), std::memory_order_release );
+        }
+    }
+
+    std::atomic< std::uint32_t > status_{ 0U };
+    std::atomic< std::uint32_t > references_{ 1U };
+    continuation                 next_{};
+    std::exception_ptr           error_{};
+    future_value< T >            value_{};
+    void ( *destroy_ )( future_state* );
+};
+
+/**
+ * @brief Owns a std::promise fed by the continuation of a future_state
+ */
+template< typename T >
+struct future_bridge
+{
+    std::promise< T >  promise_;
+    future_state< T >* state_ = nullptr;
+
+    static void fulfill( void* x )
+    {
+        std::unique_ptr< future_bridge > self( static_cast< future_bridge* >( x ) );
+        self->state_->forward( self->promise_ );
+        self->state_->release();
+    }
+};
+} // namespace detail
+
+/**
+ * @brief Future of be::promise
+ *
+ * @details Works like std::future but waits on an atomic status word instead of a mutex and
+ * condition variable. be::future can notify a continuation when it becomes ready so tasks taking
+ * them as lazy arguments are queued by the promise rather than polled by the task_pool. It converts
+ * to std::future for interoperability at the cost of an extra allocation.
+ *
+ * Threads of a task_pool blocked in get() or wait() run the queued tasks of their pool until the
+ * value is ready, so tasks may wait for tasks they submitted without tying up the thread.
+ */
+template< typename T >
+class future
+{
+public:
+    future() noexcept = default;
+    explicit future( detail::future_state< T >* state ) noexcept
+        : state_( state )
+    {
+    }
+    ~future() { release(); }
+    future( future const& ) = delete;
+    future& operator=( future const& ) = delete;
+    future( future&& other ) noexcept
+        : state_( other.state_ )
+    {
+        other.state_ = nullptr;
+    }
+    future& operator=( future&& other ) noexcept
+    {
+        if ( this != &other )
+        {
+            release();
+            state_       = other.state_;
+            other.state_ = nullptr;
+        }
+        return *this;
+    }
+
+    bool valid() const noexcept { return state_ != nullptr; }
+
+    /**
+     * @brief Waits for the value and moves it out of the future leaving it invalid
+     */
+    T get()
+    {
+        struct release_on_exit
+        {
+            future& self;
+            ~release_on_exit() { self.release(); }
+        };
+        check_state();
+        state_->wait();
+        release_on_exit guard{ *this };
+        return state_->take();
+    }
+
+    void wait() const
+    {
+        check_state();
+        state_->wait();
+    }
+
+    template< typename Rep, typename Period >
+    std::future_status wait_for( std::chrono::duration< Rep, Period > const& timeout ) const
+    {
+        check_state();
+        return state_->wait_for( std::chrono::duration_cast< std::chrono::nanoseconds >( timeout ) )
+                   ? std::future_status::ready
+                   : std::future_status::timeout;
+    }
+
+    template< typename Clock, typename Duration >
+    std::future_status wait_until( std::chrono::time_point< Clock, Duration > const& time ) const
+    {
+        return wait_for( time - Clock::now() );
+    }
+
+    /**
+     * @brief Registers a continuation to invoke once the future is ready replacing any previous
+     * continuation
+     *
+     * @return false if the future is already ready in which case the continuation is not stored
+     */
+    bool set_continuation( continuation const& next )
+    {
+        return state_ != nullptr && state_->attach( next );
+    }
+
+    /**
+     * @brief Removes the continuation waiting for it to return if it is running
+     */
+    void reset_continuation() noexcept
+    {
+        if ( state_ != nullptr )
+        {
+            state_->detach();
+        }
+    }
+
+    /**
+     * @brief Moves the result into a std::future leaving this future invalid
+     */
+    operator std::future< T >() && // NOLINT
+    {
+        check_state();
+        auto             bridge = std::make_unique< detail::future_bridge< T > >();
+        std::future< T > result = bridge->promise_.get_future();
+        bridge->state_          = state_;
+        state_                  = nullptr;
+        continuation const next{ &detail::future_bridge< T >::fulfill, bridge.get() };
+        if ( bridge->state_->attach( next ) )
+        {
+            bridge.release();
+        }
+        else
+        {
+            next.function( bridge.release() );
+        }
+        return result;
+    }
+
+private:
+    void check_state() const
+    {
+        if ( state_ == nullptr )
+        {
+            throw std::future_error( std::future_errc::no_state );
+        }
+    }
+
+    void release() noexcept
+    {
+        if ( state_ != nullptr )
+        {
+            state_->detach();
+            state_->release();
+            state_ = nullptr;
+        }
+    }
+
+    detail::future_state< T >* state_ = nullptr;
+};
+
+namespace detail {
+/**
+ * @brief Members shared by all be::promise specializations
+ */
+template< typename T >
+class promise_base
+{
+public:
+    promise_base()
+        : promise_base( std::allocator_arg_t{}, std::allocator< char >() )
+    {
+    }
+    template< typename Allocator >
+    promise_base( std::allocator_arg_t /*tag*/, Allocator const& alloc )
+        : state_( future_state< T >::create( alloc ) )
+    {
+    }
+    ~promise_base() { abandon(); }
+    promise_base( promise_base const& ) = delete;
+    promise_base& operator=( promise_base const& ) = delete;
+    promise_base( promise_base&& other ) noexcept
+        : state_( other.state_ )
+        , satisfied_( other.satisfied_ )
+    {
+        other.state_ = nullptr;
+    }
+    promise_base& operator=( promise_base&& other ) noexcept
+    {
+        if ( this != &other )
+        {
+            abandon();
+            state_       = other.state_;
+            satisfied_   = other.satisfied_;
+            other.state_ = nullptr;
+        }
+        return *this;
+    }
+
+    be::future< T > get_future()
+    {
+        if ( state_ == nullptr )
+        {
+            throw std::future_error( std::future_errc::no_state );
+        }
+        if ( state_->retrieved_ )
+        {
+            throw std::future_error( std::future_errc::future_already_retrieved );
+        }
+        state_->retrieved_ = true;
+        state_->acquire();
+        return be::future< T >( state_ );
+    }
+
+    void set_exception( std::exception_ptr error )
+    {
+        check_state();
+        state_->set_exception( std::move( error ) );
+        satisfied_ = true;
+    }
+
+protected:
+    void check_state() const
+    {
+        if ( state_ == nullptr )
+        {
+            throw std::future_error( std::future_errc::no_state );
+        }
+        if ( satisfied_ )
+        {
+            throw std::future_error( std::future_errc::promise_already_satisfied );
+        }
+    }
+
+    void abandon() noexcept
+    {
+        if ( state_ != nullptr )
+        {
+            if ( !satisfied_ )
+            {
+                state_->set_exception( std::make_exception_ptr(
+                    std::future_error( std::future_errc::broken_promise ) ) );
+            }
+            state_->release();
+            state_ = nullptr;
+        }
+    }
+
+    future_state< T >* state_     = nullptr;
+    bool               satisfied_ = false;
+};
+} // namespace detail
+
+/**
+ * @brief Promise with a single allocation shared state designed for the task_pool
+ *
+ * @details be::promise is a drop in replacement for std::promise as the promise type of submit.
+ * Its shared state is allocated once with the pool allocator and holds no mutex or condition
+ * variable. Pipelines use be::promise for every stage.
+ *
+ * @code{.cpp}
+ * auto data   = pool.submit< be::promise >( std::launch::async, &make_data );
+ * auto result = pool.submit< be::promise >( std::launch::async, &process_data, std::move( data ) );
+ * @endcode
+ */
+template< typename T >
+class promise : public detail::promise_base< T >
+{
+public:
+    using detail::promise_base< T >::promise_base;
+
+    void set_value( T const& value )
+    {
+        this->check_state();
+        this->state_->set_value( value );
+        this->satisfied_ = true;
+    }
+    void set_value( T&& value )
+    {
+        this->check_state();
+        this->state_->set_value( std::move( value ) );
+        this->satisfied_ = true;
+    }
+};
+
+template< typename T >
+class promise< T& > : public detail::promise_base< T& >
+{
+public:
+    using detail::promise_base< T& >::promise_base;
+
+    void set_value( T& value )
+    {
+        this->check_state();
+        this->state_->set_value( value );
+        this->satisfied_ = true;
+    }
+};
+
+template<>
+class promise< void > : public detail::promise_base< void >
+{
+public:
+    using detail::promise_base< void >::promise_base;
+
+    void set_value()
+    {
+        this->check_state();
+        this->state_->set_value();
+        this->satisfied_ = true;
+    }
+};
+
+/**
+ * @brief Result of when_any, the futures passed in and the index of the first that became ready
+ *
+ * @details index is std::size_t( -1 ) if there were no futures.
+ */
+template< typename Futures >
+struct when_any_result
+{
+    std::size_t index = 0;
+    Futures     futures;
+};
+
+namespace detail {
+template< typename T >
+struct when_all_result
+{
+    using type = std::vector< T >;
+};
+
+template<>
+struct when_all_result< void >
+{
+    using type = void;
+};
+
+template< typename T >
+using when_all_result_t = typename when_all_result< T >::type;
+
+/**
+ * @brief Fulfills promise with the values of futures in order or the first exception among them
+ */
+template< typename T >
+void fulfill_all( promise< std::vector< T > >& promise, std::vector< future< T > >& futures )
+{
+    std::vector< T > values;
+    values.reserve( futures.size() );
+    for ( auto& future : futures )
+    {
+        values.push_back( future.get() );
+    }
+    promise.set_value( std::move( values ) );
+}
+
+inline void fulfill_all( promise< void >& promise, std::vector< future< void > >& futures )
+{
+    for ( auto& future : futures )
+    {
+        future.get();
+    }
+    promise.set_value();
+}
+
+template< typename T >
+std::size_t future_count( std::vector< future< T > > const& futures ) noexcept
+{
+    return futures.size();
+}
+
+template< typename... Ts >
+constexpr std::size_t future_count( std::tuple< future< Ts >... > const& /*futures*/ ) noexcept
+{
+    return sizeof...( Ts );
+}
+
+/**
+ * @brief Calls func with the value of a ready future, or without arguments if it has no value
+ */
+template< typename Func,
+          typename Future,
+          std::enable_if_t< be_is_void_v< future_api::get_result_t< Future > >, bool > = true >
+decltype( auto ) invoke_continuation( Func& func, Future& future )
+{
+    future.get();
+    return func();
+}
+
+template< typename Func,
+          typename Future,
+          std::enable_if_t< !be_is_void_v< future_api::get_result_t< Future > >, bool > = true >
+decltype( auto ) invoke_continuation( Func& func, Future& future )
+{
+    return func( future.get() );
+}
+
+/**
+ * @brief Registers next on futures that can notify, returns false if it was not registered
+ */
+template< typename Future,
+          std::enable_if_t< future_api::is_notifying< Future >::value, bool > = true >
+bool subscribe_future( Future& future, continuation const& next )
+{
+    return future.set_continuation( next );
+}
+
+template< typename Future,
+          std::enable_if_t< !future_api::is_notifying< Future >::value, bool > = true >
+bool subscribe_future( Future& /*future*/, continuation const& /*next*/ )
+{
+    return false;
+}
+
+template< typename T, typename Func >
+void for_each_future( std::vector< future< T > >& futures, Func&& func )
+{
+    for ( std::size_t i = 0; i < futures.size(); ++i )
+    {
+        func( futures[i], i );
+    }
+}
+
+template< typename... Ts, typename Func, std::size_t... Is >
+void for_each_future( std::tuple< future< Ts >... >& futures,
+                      Func&&                          func,
+                      std::index_sequence< Is... > /*Is*/ )
+{
+    int const expand[] = { 0, ( func( std::get< Is >( futures ), Is ), 0 )... }; // NOLINT
+    static_cast< void >( expand );
+}
+
+template< typename... Ts, typename Func >
+void for_each_future( std::tuple< future< Ts >... >& futures, Func&& func )
+{
+    for_each_future( futures, func, std::index_sequence_for< Ts... >{} );
+}
+
+/**
+ * @brief Records which of the futures of a when_any became ready first
+ *
+ * @details Every future gets a continuation pointing at its own slot. The first to fire records
+ * its index and invokes `next_`, the others do nothing. The state is heap allocated so that the
+ * continuations stay valid while the task holding it is moved between queues.
+ */
+struct when_any_state
+{
+    struct slot
+    {
+        when_any_state* owner = nullptr;
+        std::size_t     index = 0;
+    };
+
+    explicit when_any_state( std::size_t const count )
+        : slots_( count )
+    {
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            slots_[i] = slot{ this, i };
+        }
+    }
+
+    static void ready( void* x )
+    {
+        auto* ready_slot = static_cast< slot* >( x );
+        if ( !ready_slot->owner->fired_.exchange( true ) )
+        {
+            ready_slot->owner->index_ = ready_slot->index;
+            ready_slot->owner->next_();
+        }
+    }
+
+    std::atomic< bool > fired_{ false };
+    std::size_t         index_ = static_cast< std::size_t >( -1 );
+    continuation        next_{};
+    std::vector< slot > slots_;
+};
+} // namespace detail
+
+} // namespace be
@@ -0,0 +1,269 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <task_pool/api.h>
+#include <task_pool/fallbacks.h>
+#include <task_pool/pool.h>
+#include <task_pool/stop_token.h>
+#include <task_pool/traits.h>
+#include <type_traits>
+#include <utility>
+
+namespace be {
+
+namespace detail {
+/**
+ * @brief State shared between a task_group and its tasks
+ */
+struct group_state
+{
+    stop_source                stop_;
+    std::atomic< std::size_t > pending_{ 0 }; // tasks run that have not finished
+    std::mutex                 mutex_;
+    std::condition_variable    finished_;
+    std::exception_ptr         error_;
+
+    void finish()
+    {
+        if ( pending_.fetch_sub( 1U ) == 1U )
+        {
+            // waiters test pending_ under the mutex
+            std::unique_lock< std::mutex > lock( mutex_ );
+            finished_.notify_all();
+        }
+    }
+
+    /**
+     * @brief Keeps the first error and cancels the tasks of the group that have not started
+     */
+    void fail( std::exception_ptr error )
+    {
+        {
+            std::unique_lock< std::mutex > lock( mutex_ );
+            if ( !error_ )
+            {
+                error_ = std::move( error );
+            }
+        }
+        stop_.request_stop();
+    }
+};
+
+/**
+ * @brief Counts a task of a group as finished when the task is destroyed
+ *
+ * @details A task that is destroyed without running, because the pool rejected or dropped it or
+ * was aborted, fails its group with std::future_errc::broken_promise like the future of a task
+ * would.
+ */
+class group_ticket
+{
+public:
+    explicit group_ticket( std::shared_ptr< group_state > state ) noexcept
+        : state_( std::move( state ) )
+    {
+    }
+    ~group_ticket()
+    {
+        if ( state_ )
+        {
+            if ( !ran_ )
+            {
+                state_->fail( std::make_exception_ptr(
+                    std::future_error( std::future_errc::broken_promise ) ) );
+            }
+            state_->finish();
+        }
+    }
+    group_ticket( group_ticket const& ) = delete;
+    group_ticket& operator=( group_ticket const& ) = delete;
+    group_ticket( group_ticket&& other ) noexcept
+        : state_( std::move( other.state_ ) )
+        , ran_( other.ran_ )
+    {
+    }
+    group_ticket& operator=( group_ticket&& ) = delete;
+
+    group_state& state() const noexcept { return *state_; }
+    void         ran() noexcept { ran_ = true; }
+
+private:
+    std::shared_ptr< group_state > state_;
+    bool                           ran_ = false;
+};
+} // namespace detail
+
+/**
+ * @brief Runs tasks in a task_pool that are waited for, and cancelled, together
+ *
+ * @details Tasks take no arguments or a be::stop_token which fires when the group is cancelled
+ * or the pool aborts.
+ * Instead of a promise per task the group counts the tasks that have not finished. The first
+ * exception thrown by a task cancels the group and is rethrown by wait(). Tasks of a cancelled
+ * group that have not started are skipped while running tasks may stop early by checking their
+ * token, cancelling one group leaves the pool and all other groups alone.
+ *
+ * The thread calling wait() runs queued tasks of the pool meanwhile so tasks may create groups of
+ * their own and wait for them. The group waits for its tasks on destruction.
+ *
+ * @code{.cpp}
+ * be::task_group group( pool );
+ * group.run( [&] { parse( header ); } );
+ * group.run( [&]( be::stop_token token ) { parse( body, token ); } );
+ * group.wait(); // rethrows the first exception of the tasks
+ * @endcode
+ */
+template< class Allocator, class ReadyQueue >
+class task_group_t
+{
+public:
+    using pool_type = task_pool_t< Allocator, ReadyQueue >;
+
+    explicit task_group_t( pool_type& pool )
+        : pool_( pool )
+        , state_( std::make_shared< detail::group_state >() )
+    {
+    }
+    ~task_group_t()
+    {
+        try
+        {
+            wait();
+        }
+        catch ( ... ) // NOLINT (bugprone-empty-catch)
+        {
+            // errors are only reported through wait()
+        }
+    }
+    task_group_t( task_group_t const& ) = delete;
+    task_group_t& operator=( task_group_t const& ) = delete;
+    task_group_t( task_group_t&& )                 = delete;
+    task_group_t& operator=( task_group_t&& ) = delete;
+
+    /**
+     * @brief Runs a task as part of the group
+     *
+     * @param task A callable value type, void() or void( be::stop_token )
+     */
+    template< typename Func >
+    void run( Func&& task )
+    {
+        run( task_options{}, std::forward< Func >( task ) );
+    }
+
+    template< typename Func >
+    void run( task_options options, Func&& task )
+    {
+        state_->pending_.fetch_add( 1U );
+        detail::group_ticket ticket( state_ );
+        pool_.runtime_->push_task(
+            options,
+            pool_.make_task( [ticket        = std::move( ticket ),
+                              token         = get_stop_token(),
+                              task_function = std::decay_t< Func >(
+                                  std::forward< Func >( task ) )]() mutable {
+                ticket.ran();
+                if ( token.stop_requested() )
+                {
+                    return;
+                }
+                try
+                {
+                    // a task cancelled through its options fails the group
+                    pool_type::pool_runtime::throw_if_cancelled();
+                    invoke( task_function, token );
+                }
+                catch ( ... )
+                {
+                    ticket.state().fail( std::current_exception() );
+                }
+            } ) );
+    }
+
+    /**
+     * @brief Waits for all tasks of the group, rethrowing the first exception one of them threw
+     *
+     * @details The group may be used again once wait() returned, its cancellation and error are
+     * reset. No tasks may be added to the group while another thread waits for it.
+     */
+    void wait()
+    {
+        auto&    runtime = *pool_.runtime_;
+        unsigned slot    = runtime.caller_slot();
+        while ( state_->pending_.load() != 0U )
+        {
+            if ( runtime.run_next_task( slot ) )
+            {
+                continue;
+            }
+            std::unique_lock< std::mutex > lock( state_->mutex_ );
+            auto const finished = [this] { return state_->pending_.load() == 0U; };
+            if ( slot == runtime.thread_capacity_ )
+            {
+                // the threads of the pool will finish the tasks
+                state_->finished_.wait( lock, finished );
+            }
+            else
+            {
+                // a thread of the pool looks for tasks again since it might be the only one left
+                state_->finished_.wait_for( lock, std::chrono::microseconds( 50 ), finished );
+            }
+        }
+        std::exception_ptr error;
+        {
+            std::unique_lock< std::mutex > lock( state_->mutex_ );
+            std::swap( error, state_->error_ );
+            if ( state_->stop_.stop_requested() )
+            {
+                state_->stop_ = stop_source{};
+            }
+        }
+        if ( error )
+        {
+            std::rethrow_exception( error );
+        }
+    }
+
+    /**
+     * @brief Fires the stop_token of the group, tasks that have not started are skipped
+     */
+    void cancel() noexcept { state_->stop_.request_stop(); }
+
+    BE_NODISGARD bool is_cancelled() const noexcept { return state_->stop_.stop_requested(); }
+
+    /**
+     * @brief Returns the token handed to the tasks of the group
+     *
+     * @details Tokens taken before wait() reset the group stay fired.
+     */
+    BE_NODISGARD stop_token get_stop_token() const noexcept
+    {
+        return state_->stop_.get_token().chain( pool_.get_stop_token() );
+    }
+
+private:
+    template< typename Func, std::enable_if_t< wants_stop_token_v< Func >, bool > = true >
+    static void invoke( Func& task, stop_token const& token )
+    {
+        task( token );
+    }
+
+    template< typename Func, std::enable_if_t< !wants_stop_token_v< Func >, bool > = true >
+    static void invoke( Func& task, stop_token const& /*token*/ )
+    {
+        task();
+    }
+
+    pool_type&                             pool_;
+    std::shared_ptr< detail::group_state > state_;
+};
+
+using task_group = task_group_t< std::allocator< void > >;
+
+} // namespace be
@@ -2,6 +2,7 @@
 #include <chrono>
 #include <future>
 #include <task_pool/fallbacks.h>
+#include <task_pool/futures.h>
 #include <task_pool/pool.h>
 #include <task_pool/traits.h>
 #include <type_traits>
@@ -17,10 +18,24 @@ struct detach_t
         return static_cast< typename Pipe::future_type >( pipe );
     }
 };
-static detach_t detach{}; // NOLINT
+static constexpr detach_t detach{}; // NOLINT
 
-template< typename Allocator, typename Func, typename... Args >
-TASKPOOL_HIDDEN auto make_pipe( be::task_pool_t< Allocator >& pool, Func&& func, Args&&... args )
+/**
+ * @brief Starts a pipeline whose stages are all submitted with the given options
+ *
+ * @details A stop_token in the options cancels the stages that have not started, their futures
+ * complete with be::task_cancelled.
+ *
+ * @code{.cpp}
+ * be::stop_source cancel;
+ * auto result = be::make_pipe( pool, { std::launch::async, cancel.get_token() }, read ) | parse;
+ * @endcode
+ */
+template< typename Allocator, typename ReadyQueue, typename Func, typename... Args >
+TASKPOOL_HIDDEN auto make_pipe( be::task_pool_t< Allocator, ReadyQueue >& pool,
+                                task_options                              options,
+                                Func&&                                    func,
+                                Args&&... args )
 {
     struct TASKPOOL_HIDDEN pipe_
     {
@@ -28,21 +43,25 @@ TASKPOOL_HIDDEN auto make_pipe( be::task_pool_t< Allocator >& pool, Func&& func,
         // For some reason these following typesdefs are considered unused by clang although they
         // are most certainly used in the defined class
         //
-        using future_type    = decltype( std::declval< be::task_pool_t< Allocator > >().submit(
-            std::launch::async,
-            std::declval< Func >(),
-            std::forward< Args >( std::declval< Args >() )... ) );
+        using allocator_type = Allocator;
+        using pool_type      = be::task_pool_t< allocator_type, ReadyQueue >;
+        using future_type    = decltype( std::declval< pool_type >()
+                                          .template submit< be::promise >(
+                                              std::launch::async,
+                                              std::declval< Func >(),
+                                              std::forward< Args >( std::declval< Args >() )... ) );
         using value_type     = decltype( std::declval< future_type >().get() );
         using status_type    = decltype( std::declval< future_type >().wait_for(
             std::declval< std::chrono::seconds >() ) );
-        using allocator_type = Allocator;
 
-        be::task_pool_t< allocator_type >& pool_;
-        be::stop_token                     abort_;
-        future_type                        future_;
-        pipe_( be::task_pool_t< allocator_type >& x, future_type&& y )
+        pool_type&     pool_;
+        be::stop_token abort_;
+        task_options   options_; // of every stage
+        future_type    future_;
+        pipe_( pool_type& x, task_options const& o, future_type&& y )
             : pool_( x )
             , abort_( x.get_stop_token() )
+            , options_( o )
             , future_( std::move( y ) )
         {
         }
@@ -58,10 +77,15 @@ TASKPOOL_HIDDEN auto make_pipe( be::task_pool_t< Allocator >& pool, Func&& func,
         pipe_( pipe_&& x ) noexcept
             : pool_( x.pool_ )
             , abort_( x.abort_ )
+            , options_( x.options_ )
             , future_( std::move( x.future_ ) ){};
         pipe_& operator=( pipe_&& x ) noexcept = delete;
 
         explicit operator future_type() noexcept { return std::move( future_ ); }
+        explicit operator std::future< value_type >()
+        {
+            return static_cast< std::future< value_type > >( std::move( future_ ) );
+        }
 
         void                     wait() const { future_.wait(); }
         value_type               get() { return future_.get(); }
@@ -74,10 +98,24 @@ TASKPOOL_HIDDEN auto make_pipe( be::task_pool_t< Allocator >& pool, Func&& func,
             return future_.wait_until( ns );
         }
     };
-    return pipe_( pool,
-                  pool.submit( std::launch::async,
-                               std::forward< Func >( func ),
-                               std::forward< Args >( args )... ) );
+    // stages use be::promise so the next stage is queued by the completion of this one rather
+    // than being polled by the task_checker
+    auto future = pool.template submit< be::promise >(
+        options, std::forward< Func >( func ), std::forward< Args >( args )... );
+    return pipe_( pool, options, std::move( future ) );
+}
+
+template< typename Allocator,
+          typename ReadyQueue,
+          typename Func,
+          typename... Args,
+          std::enable_if_t< !std::is_same< std::decay_t< Func >, task_options >::value, bool > =
+              true >
+TASKPOOL_HIDDEN auto
+make_pipe( be::task_pool_t< Allocator, ReadyQueue >& pool, Func&& func, Args&&... args )
+{
+    return make_pipe(
+        pool, task_options{}, std::forward< Func >( func ), std::forward< Args >( args )... );
 }
 
 template< typename TaskPool,
@@ -97,7 +135,7 @@ template< typename Pipe,
                             bool > = true >
 auto operator|( Pipe&& p, Func&& f )
 {
-    return make_pipe( p.pool_, std::forward< Func >( f ), std::move( p.future_ ) );
+    return make_pipe( p.pool_, p.options_, std::forward< Func >( f ), std::move( p.future_ ) );
 }
 
 template< typename Pipe, std::enable_if_t< is_pipe< Pipe >::value, bool > = true >
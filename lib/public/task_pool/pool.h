@@ -1,56 +1,564 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <exception>
 #include <functional>
 #include <future>
+#include <iterator>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <new>
 #include <queue>
+#include <string>
 #include <task_pool/api.h>
 #include <task_pool/fallbacks.h>
+#include <task_pool/futures.h>
+#include <task_pool/queues.h>
+#include <task_pool/stop_token.h>
+#include <task_pool/timers.h>
 #include <task_pool/traits.h>
 #include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined( _M_IX86 ) || defined( _M_X64 )
+#    include <intrin.h>
+#endif
+
+/**
+ * @brief Bytes of storage reserved inside each queued task for the task itself
+ *
+ * @details Tasks that do not fit are allocated with the pool allocator. The value changes the
+ * layout of task_pool_t and must be the same for the library and every translation unit using it.
+ */
+#if !defined( BE_TASK_INLINE_SIZE )
+#    define BE_TASK_INLINE_SIZE 128
+#endif
+
+/**
+ * @brief Set to 0 to compile out the per thread counters reported by task_pool_t::stats
+ *
+ * @details Like BE_TASK_INLINE_SIZE it must be the same for the library and every translation
+ * unit using it, the TASKPOOL_STATS cmake option takes care of that.
+ */
+#if !defined( BE_TASK_STATS )
+#    define BE_TASK_STATS 1
+#endif
+
 namespace be {
 /**
- * @brief Allows tasks to participate in cooperative cancellation
+ * @brief Selects how a task_pool distributes tasks between its threads
+ *
+ * @details `shared_queue` pushes every task through a single queue guarded by one mutex which is
+ * simple and fair but becomes a point of contention when many threads submit and dequeue fine
+ * grained tasks.
+ *
+ * `work_stealing` gives every thread a deque of its own. Tasks submitted from inside a task
+ * running in the pool go to the deque of the submitting thread and are picked up again in last in
+ * first out order while tasks submitted from other threads go to a shared injection queue. Threads
+ * that run out of work steal the oldest tasks from the deques of other threads.
+ */
+enum class schedule_policy
+{
+    shared_queue,
+    work_stealing,
+};
+
+/**
+ * @brief Selects what threads without work do before they go to sleep
+ *
+ * @details Idle threads first spin on the queue counters, then yield their time slice and finally
+ * sleep until a task is queued. `latency` spins and yields long enough to pick up tasks queued in
+ * quick succession without a wakeup. `power` goes to sleep almost immediately which suits mostly
+ * idle processes.
+ *
+ * Sleeping threads are woken by queued tasks and have no timeout unless tasks with lazy arguments
+ * that have to be polled are waiting, see pool_options::check_latency.
+ */
+enum class idle_policy
+{
+    latency,
+    power,
+};
+
+/**
+ * @brief What submitting a task to a pool whose queues are at pool_options::queue_capacity does
+ *
+ * @details `block` waits for a queued task to start, `reject` does not queue the task leaving
+ * its future with a broken promise, `caller_runs` runs the task on the submitting thread and
+ * `drop_oldest` discards the oldest task of the lowest priority shared queue, whose future is left
+ * with a broken promise. Pool threads never block since that could leave no thread to make room,
+ * they run the task themselves instead. Tasks waiting for their arguments can not run on the
+ * caller, `caller_runs` blocks for those and `drop_oldest` rejects the new task if no shared task
+ * is queued. Deferred tasks only leave the queues through invoke_deferred() so if they alone fill
+ * the pool a blocked submitter invokes them, and rejects its task if they still wait for their
+ * arguments afterwards.
+ */
+enum class overflow_policy
+{
+    block,
+    reject,
+    caller_runs,
+    drop_oldest,
+};
+
+/**
+ * @brief Selects whether a task_pool groups its threads by NUMA node
+ *
+ * @details `node_groups` splits the threads into one group per node, pins every group to the
+ * processors of its node and gives each group a ready queue of its own. Tasks of normal priority
+ * are queued on the node of the submitting thread, which has written their inline storage, so
+ * they tend to run where their memory is. Threads only take tasks queued on other nodes once
+ * their own node has run out of work. Tasks of other priorities go through the shared queues.
+ */
+enum class numa_policy
+{
+    none,
+    node_groups,
+};
+
+/**
+ * @brief The processors of one NUMA node
+ */
+struct numa_node
+{
+    unsigned                id = 0;
+    std::vector< unsigned > cpus;
+};
+
+using numa_topology = std::vector< numa_node >;
+
+/**
+ * @brief Reads the NUMA nodes of the machine from the `node<N>/cpulist` files below root
+ *
+ * @details Returns no nodes if root does not exist or on systems other than linux. Nodes without
+ * processors, such as memory only nodes, are left out.
+ */
+TASKPOOL_API numa_topology
+read_numa_topology( std::string const& root = "/sys/devices/system/node" );
+
+namespace detail {
+/**
+ * @brief Parses a list of processors like `0-3,8-11` as found in sysfs, invalid entries are skipped
+ */
+TASKPOOL_API std::vector< unsigned > parse_cpu_list( std::string const& list );
+
+/**
+ * @brief Restricts the calling thread to the given processors, returns false if that failed
+ */
+TASKPOOL_API bool pin_current_thread( std::vector< unsigned > const& cpus ) noexcept;
+
+/**
+ * @brief Returns the processor the calling thread runs on or -1 if that is unknown
+ */
+TASKPOOL_API int current_cpu() noexcept;
+} // namespace detail
+
+/**
+ * @brief Priority of a task, tasks of higher priority are started first
+ *
+ * @details Pools have three priority levels unless pool_options::priority_levels says otherwise.
+ * Additional levels are used by casting their index, level zero being the highest. Levels past
+ * the last level of a pool are treated as its last level.
+ */
+enum class task_priority : unsigned
+{
+    high   = 0,
+    normal = 1,
+    low    = 2,
+};
+
+/**
+ * @brief Options for a single task
  *
- * @details Users may submit tasks that take a be::stop_token as its last
- * argument and the task_pool will provide a token for the function when
- * executing that may be used to break out of long running work.
+ * @details task_options are implicitly constructible from std::launch so submit accepts either.
  *
  * @code{.cpp}
- * pool.submit( []( be::stop_token token ){ while( !token ) { //process things }
- * );
+ * pool.submit( { std::launch::async, be::task_priority::high }, &handle_request, request );
  * @endcode
+ */
+struct task_options
+{
+    std::launch   launch   = std::launch::async;
+    task_priority priority = task_priority::normal;
+    /**
+     * @brief Cancels the task if it fires before the task started, see be::stop_source
+     */
+    stop_token stop;
+    /**
+     * @brief Cancels the task with be::deadline_exceeded if it has not started by then, the
+     * latest time point for none. be::deadline_ready_queue runs tasks earliest deadline first.
+     */
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    task_options() = default;
+    task_options( std::launch policy ) noexcept // NOLINT implicit by design
+        : launch( policy )
+    {
+    }
+    task_options( std::launch policy, task_priority level ) noexcept
+        : launch( policy )
+        , priority( level )
+    {
+    }
+    task_options( std::launch policy, stop_token token ) noexcept
+        : launch( policy )
+        , stop( std::move( token ) )
+    {
+    }
+    task_options( std::launch policy, task_priority level, stop_token token ) noexcept
+        : launch( policy )
+        , priority( level )
+        , stop( std::move( token ) )
+    {
+    }
+    task_options( std::launch policy, std::chrono::steady_clock::time_point due ) noexcept
+        : launch( policy )
+        , deadline( due )
+    {
+    }
+    task_options( std::launch                                 policy,
+                  task_priority                               level,
+                  std::chrono::steady_clock::time_point const due ) noexcept
+        : launch( policy )
+        , priority( level )
+        , deadline( due )
+    {
+    }
+};
+
+/**
+ * @brief Scheduling policy of the threads of a task_pool as seen by the operating system
+ *
+ * @details `inherit` keeps the policy of the thread constructing the pool. `fifo` and
+ * `round_robin` are real time policies which usually require elevated rights. Only linux applies
+ * these, elsewhere they are ignored.
+ */
+enum class thread_policy
+{
+    inherit,
+    normal,
+    batch,
+    idle,
+    fifo,
+    round_robin,
+};
+
+/**
+ * @brief Operating system settings of the threads of a task_pool
  *
- * stop_tokens are a means to abort running operations and as such do not fire
- * when the task_pool is trying to complete work using
- * `task_pool::wait_for_tasks` however it does fire on destruction.
+ * @details Settings are applied by each thread before it runs any task. Settings the process
+ * lacks the rights for are skipped.
+ *
+ * @code{.cpp}
+ * be::pool_options options;
+ * options.thread_count        = 4;
+ * options.threads.cpu_sets    = { { 4 }, { 5 }, { 6 }, { 7 } }; // away from the network threads
+ * options.threads.name_prefix = "pool-";
+ * be::task_pool pool( options );
+ * @endcode
+ */
+struct thread_options
+{
+    /**
+     * @brief Thread i is pinned to cpu_sets[i % cpu_sets.size()], empty to leave the threads
+     * unpinned or pinned to their NUMA node
+     */
+    std::vector< std::vector< unsigned > > cpu_sets;
+    /**
+     * @brief Threads are named by the prefix followed by their index, empty to keep the name.
+     * Linux cuts names to 15 characters.
+     */
+    std::string name_prefix;
+    /**
+     * @brief Stack size of the threads in bytes, zero for the system default
+     */
+    std::size_t stack_size = 0;
+    /**
+     * @brief The scheduling policy of the threads
+     */
+    thread_policy policy = thread_policy::inherit;
+    /**
+     * @brief The real time priority used with thread_policy::fifo and thread_policy::round_robin
+     */
+    int priority = 0;
+    /**
+     * @brief The nice value of the threads on linux, zero to keep the one of the constructing
+     * thread
+     */
+    int nice = 0;
+    /**
+     * @brief Called by each thread with its index before it runs any task, must not throw
+     */
+    std::function< void( unsigned ) > on_start;
+    /**
+     * @brief Called by each thread with its index before it exits, must not throw
+     */
+    std::function< void( unsigned ) > on_stop;
+};
+
+namespace detail {
+/**
+ * @brief Applies the settings of options to the calling thread which has the given index
+ */
+TASKPOOL_API void configure_thread( thread_options const& options, unsigned index );
+
+/**
+ * @brief Thread that unlike std::thread can be given a stack size, joined on destruction
+ */
+class TASKPOOL_API worker_thread
+{
+public:
+    worker_thread() noexcept;
+    worker_thread( std::size_t stack_size, std::function< void() > entry );
+    worker_thread( worker_thread&& other ) noexcept;
+    worker_thread& operator=( worker_thread&& other ) noexcept;
+    worker_thread( worker_thread const& ) = delete;
+    worker_thread& operator=( worker_thread const& ) = delete;
+    ~worker_thread();
+
+    bool joinable() const noexcept { return static_cast< bool >( handle_ ); }
+    void join();
+
+private:
+    struct handle;
+    std::unique_ptr< handle > handle_;
+};
+} // namespace detail
+
+/**
+ * @brief Options used when constructing a task_pool
  *
  * @code{.cpp}
- * {
- *     task_pool pool;
- *     auto f = pool.submit( []( be::stop_token token ){ while( !token ) {
- * std::this_thread::sleep_for(1ms); } );
- *     // pool.wait_for_tasks(); // <-- this would deadlock
- * }                             // <-- destruction fires the stop token
- * allowing task to complete
+ * be::pool_options options;
+ * options.thread_count = 8;
+ * options.scheduling   = be::schedule_policy::work_stealing;
+ * be::task_pool pool( options );
  * @endcode
+ */
+struct pool_options
+{
+    /**
+     * @brief The desired amount of threads, zero translates to std::thread::hardware_concurrency
+     */
+    unsigned thread_count = 0;
+    /**
+     * @brief Maximum duration used to wait prior to checking lazy input arguments
+     */
+    std::chrono::nanoseconds check_latency = std::chrono::microseconds( 1 );
+    /**
+     * @brief Maximum number of tasks waiting for lazy arguments checked at a time, the next check
+     * continues where the last one stopped
+     */
+    std::size_t check_batch = 1024;
+    /**
+     * @brief How tasks are distributed between the threads of the pool
+     */
+    schedule_policy scheduling = schedule_policy::shared_queue;
+    /**
+     * @brief What threads without work do before they go to sleep
+     */
+    idle_policy idle = idle_policy::latency;
+    /**
+     * @brief The number of task priority levels, zero is treated as one
+     */
+    unsigned priority_levels = 3;
+    /**
+     * @brief Queued tasks are promoted one priority level for every priority_aging tasks started
+     * ahead of them so that lower priorities can not starve, zero disables aging
+     */
+    unsigned priority_aging = 64;
+    /**
+     * @brief Whether threads are grouped by NUMA node
+     */
+    numa_policy numa = numa_policy::none;
+    /**
+     * @brief The nodes used by numa_policy::node_groups, empty to read them with
+     * read_numa_topology. There is one group for each node as long as there are enough threads.
+     */
+    numa_topology topology{};
+    /**
+     * @brief Operating system settings of the threads
+     */
+    thread_options threads{};
+    /**
+     * @brief Threads are added on load up to this count, zero or anything up to thread_count
+     * keeps the number of threads fixed
+     */
+    unsigned max_thread_count = 0;
+    /**
+     * @brief How often an elastic pool checks its load, a thread is added if tasks stayed queued
+     * for two checks in a row while no thread was sleeping
+     */
+    std::chrono::nanoseconds grow_queue_wait = std::chrono::milliseconds( 1 );
+    /**
+     * @brief Queued tasks per thread above which a thread is added at the next check of the load
+     * regardless of how long they have been waiting
+     */
+    std::size_t grow_queue_depth = 4;
+    /**
+     * @brief Time after which idle threads above thread_count exit
+     */
+    std::chrono::nanoseconds keep_alive = std::chrono::seconds( 10 );
+    /**
+     * @brief Number of queued, deferred and waiting tasks at which overflow applies, zero for no
+     * limit
+     */
+    std::size_t queue_capacity = 0;
+    /**
+     * @brief What submitting a task does while queue_capacity tasks are queued
+     */
+    overflow_policy overflow = overflow_policy::block;
+    /**
+     * @brief Granularity of the timers of submit_after, submit_at and submit_every, timers fire
+     * at the first multiple of it after they are due
+     */
+    std::chrono::nanoseconds timer_resolution = std::chrono::milliseconds( 1 );
+};
+
+namespace detail {
+/**
+ * @brief Hints the processor that the calling thread is spinning
+ */
+inline void cpu_relax() noexcept
+{
+#if defined( __i386__ ) || defined( __x86_64__ )
+    __builtin_ia32_pause();
+#elif defined( _M_IX86 ) || defined( _M_X64 )
+    _mm_pause();
+#elif defined( __aarch64__ ) || defined( __arm__ )
+    __asm__ __volatile__( "yield" );
+#endif
+}
+
+/**
+ * @brief Counter split into one cache line per slot that is summed up on read
  *
+ * @details Each thread counts in a slot of its own so counting does not bounce a shared cache
+ * line between the cores. The sum is read one slot after the other, it is exact if every slot
+ * is only changed while what it counts is locked and otherwise as current as the slowest read.
+ */
+class sharded_counter
+{
+public:
+    explicit sharded_counter( std::size_t const slots ) : slots_( slots ) {}
+
+    void add( std::size_t const index, std::ptrdiff_t const delta ) noexcept
+    {
+        slots_[index].value_.fetch_add( delta );
+    }
+
+    std::size_t load() const noexcept
+    {
+        std::ptrdiff_t sum = 0;
+        for ( auto const& counted : slots_ )
+        {
+            sum += counted.value_.load();
+        }
+        return sum > 0 ? static_cast< std::size_t >( sum ) : 0U;
+    }
+
+    std::size_t load( std::size_t const index ) const noexcept
+    {
+        std::ptrdiff_t const value = slots_[index].value_.load();
+        return value > 0 ? static_cast< std::size_t >( value ) : 0U;
+    }
+
+    std::size_t size() const noexcept { return slots_.size(); }
+
+private:
+    struct slot
+    {
+        cache_line_padding            front_padding_{};
+        std::atomic< std::ptrdiff_t > value_{ 0 };
+        cache_line_padding            back_padding_{};
+    };
+    std::vector< slot > slots_;
+};
+
+/**
+ * @brief Atomic counter on a cache line of its own, for arrays of counters written by many threads
+ */
+struct padded_counter
+{
+    cache_line_padding         front_padding_{};
+    std::atomic< std::size_t > value_{ 0 };
+    cache_line_padding         back_padding_{};
+};
+
+/**
+ * @brief Start of an interval measured for the pool statistics, empty if BE_TASK_STATS is 0
+ */
+struct stats_timer
+{
+#if BE_TASK_STATS
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+    std::int64_t elapsed() const noexcept
+    {
+        return std::chrono::duration_cast< std::chrono::nanoseconds >(
+                   std::chrono::steady_clock::now() - start_ )
+            .count();
+    }
+#else
+    std::int64_t elapsed() const noexcept { return 0; }
+#endif
+};
+} // namespace detail
+
+/**
+ * @brief Counters of a single thread of a task_pool, see task_pool_t::stats
+ */
+struct worker_stats
+{
+    std::uint64_t            tasks_executed   = 0;
+    std::uint64_t            wakeups          = 0; // times the thread woke up after sleeping
+    std::uint64_t            spurious_wakeups = 0; // wakeups finding no task, mostly polling
+    std::chrono::nanoseconds busy_time{ 0 };       // running tasks
+    std::chrono::nanoseconds idle_time{ 0 };       // spinning and sleeping while out of work
+    std::chrono::nanoseconds checker_time{ 0 };    // polling lazy arguments as task_checker
+    std::chrono::nanoseconds queue_wait_time{ 0 }; // summed time from queueing to starting tasks
+    std::uint64_t            deadline_misses  = 0; // tasks cancelled as their deadline passed
+    std::size_t              tasks_polled     = 0; // lazy tasks in the check shard of the thread
+};
+
+/**
+ * @brief Snapshot of the counters of every thread of a task_pool
  */
-struct TASKPOOL_API stop_token
+struct pool_stats
 {
-    std::atomic_bool const& token;
+    std::vector< worker_stats > workers;
+    worker_stats                helpers; // tasks run by threads outside the pool in wait()
 
-    explicit operator bool();
+    /**
+     * @brief Returns the counters of all threads added up, including the helpers
+     */
+    worker_stats total() const noexcept
+    {
+        worker_stats sum = helpers;
+        for ( auto const& worker : workers )
+        {
+            sum.tasks_executed += worker.tasks_executed;
+            sum.wakeups += worker.wakeups;
+            sum.spurious_wakeups += worker.spurious_wakeups;
+            sum.busy_time += worker.busy_time;
+            sum.idle_time += worker.idle_time;
+            sum.checker_time += worker.checker_time;
+            sum.queue_wait_time += worker.queue_wait_time;
+            sum.deadline_misses += worker.deadline_misses;
+            sum.tasks_polled += worker.tasks_polled;
+        }
+        return sum;
+    }
 };
 
 /**
@@ -62,12 +570,14 @@ struct TASKPOOL_API stop_token
  * task_pool instances are fixed size thread pools that are intended to execute
  * descreet tasks either independently or linked by futures.
  *
+ * @tparam ReadyQueue - policy selecting the queue type of the shared ready queues, either
+ * locked_ready_queue or lock_free_ready_queue
  */
 
 // template< template< typename, typename... > class Allocator, typename Value, typename... Ts >
 // class TASKPOOL_API task_pool_t< Allocator< Value, Ts... > >
 
-template< typename Allocator >
+template< typename Allocator, typename ReadyQueue >
 class TASKPOOL_API task_pool_t
 {
 public:
@@ -145,6 +655,31 @@ public:
         : task_pool_t( std::chrono::microseconds( 1 ), thread_count, alloc )
     {
     }
+
+    /**
+     * @brief Construct a new task pool object
+     *
+     * @param options - thread count, lazy argument checker latency and scheduling of the pool
+     *
+     * @details The specified allocator of the pool must be default constructable.
+     */
+    explicit task_pool_t( pool_options const& options )
+        : runtime_( std::make_unique< pool_runtime >( options ) )
+        , allocator_()
+    {
+    }
+
+    /**
+     * @brief Construct a new task pool object
+     *
+     * @param options - thread count, lazy argument checker latency and scheduling of the pool
+     * @param alloc   - Allocator instance of the type specified for the pool.
+     */
+    task_pool_t( pool_options const& options, Allocator const& alloc )
+        : runtime_( std::make_unique< pool_runtime >( options ) )
+        , allocator_( alloc )
+    {
+    }
     /**
      * @brief Destroys the task_pool. Will attempt to cancel tasks that support it
      * and join all threads.
@@ -195,8 +730,7 @@ public:
         const bool was_paused = is_paused();
         pause();
         wait();
-        runtime_.reset( new ( std::nothrow )
-                            pool_runtime( get_check_latency(), requested_thread_count ) );
+        runtime_.reset( new ( std::nothrow ) pool_runtime( get_options( requested_thread_count ) ) );
         if ( !runtime_ )
         {
             // new reset() will only throw in the case of std::bad_alloc and since we have
@@ -220,10 +754,9 @@ public:
      */
     void abort() noexcept
     {
-        auto thread_count = get_thread_count();
-        auto latency      = get_check_latency();
+        auto options = get_options( ( *runtime_ ).min_threads_ );
         ( *runtime_ ).abort();
-        runtime_.reset( new ( std::nothrow ) pool_runtime( latency, thread_count ) );
+        runtime_.reset( new ( std::nothrow ) pool_runtime( options ) );
         if ( !runtime_ )
         {
             // new reset() will only throw in the case of std::bad_alloc and since we have
@@ -238,7 +771,51 @@ public:
      */
     BE_NODISGARD std::size_t get_tasks_queued() const noexcept
     {
-        return ( *runtime_ ).tasks_queued_;
+        return ( *runtime_ ).tasks_queued();
+    }
+
+    /**
+     * @brief Returns the amount of tasks of the given priority in the pool not currently running
+     */
+    BE_NODISGARD std::size_t get_tasks_queued( task_priority priority ) const noexcept
+    {
+        return ( *runtime_ ).tasks_queued( ( *runtime_ ).level_of( priority ) );
+    }
+
+    /**
+     * @brief Returns the number of task priority levels of the pool
+     */
+    BE_NODISGARD unsigned get_priority_levels() const noexcept
+    {
+        return static_cast< unsigned >( ( *runtime_ ).tasks_.size() );
+    }
+
+    /**
+     * @brief Returns a snapshot of the counters kept by each thread of the pool
+     *
+     * @details There is one entry per thread slot up to get_thread_capacity(), slots of threads
+     * that exited keep their counts. Tasks that threads outside the pool ran while helping in
+     * wait() are counted in `helpers`, concurrent helpers may lose some of those counts. Counters
+     * start at zero with the threads, that is on construction, reset() and abort(). They are all
+     * zero if the library was built with BE_TASK_STATS set to 0, except `tasks_polled` which is
+     * the number of tasks currently in the check shard of each thread.
+     */
+    BE_NODISGARD pool_stats stats() const
+    {
+        pool_stats result;
+        auto const& runtime = *runtime_;
+        result.workers.reserve( runtime.worker_counters_.size() );
+        for ( auto const& counters : runtime.worker_counters_ )
+        {
+            result.workers.push_back( counters.snapshot() );
+            auto const index = result.workers.size() - 1;
+            if ( index < runtime.check_shards_.size() )
+            {
+                result.workers.back().tasks_polled = runtime.check_shards_[index].waiting_.load();
+            }
+        }
+        result.helpers = ( *runtime_ ).helper_counters_.snapshot();
+        return result;
     }
 
     /**
@@ -246,7 +823,7 @@ public:
      */
     BE_NODISGARD std::size_t get_tasks_running() const noexcept
     {
-        return ( *runtime_ ).tasks_running_;
+        return ( *runtime_ ).tasks_running_.load();
     }
     /**
      * @brief Returns the amount of tasks in the pool currently awaiting input arguments
@@ -256,22 +833,50 @@ public:
         return ( *runtime_ ).tasks_waiting_;
     }
 
+    /**
+     * @brief Returns the amount of timers that have not expired, periodic timers count until they
+     * are cancelled
+     */
+    BE_NODISGARD std::size_t get_timers_pending() const noexcept
+    {
+        return ( *runtime_ ).timers_pending_;
+    }
+
     /**
      * @brief Returns the total amount of tasks in the pool, queued, running and waiting
      */
     BE_NODISGARD std::size_t get_tasks_total() const noexcept
     {
-        return ( *runtime_ ).tasks_queued_ + ( *runtime_ ).tasks_running_ +
-               ( *runtime_ ).tasks_waiting_;
+        return ( *runtime_ ).tasks_total();
     }
 
     /**
-     * @brief Returns the amount of threads in the pool
+     * @brief Returns the amount of threads in the pool, elastic pools and set_thread_count() change
+     * it while the pool runs
      */
     BE_NODISGARD unsigned get_thread_count() const noexcept { return ( *runtime_ ).thread_count_; }
 
     /**
-     * @brief Returns if the pool has been paused
+     * @brief Returns the number of threads the pool can have without reset(), the larger of
+     * pool_options::thread_count and pool_options::max_thread_count
+     */
+    BE_NODISGARD unsigned get_thread_capacity() const noexcept
+    {
+        return ( *runtime_ ).thread_capacity_;
+    }
+
+    /**
+     * @brief Changes the number of threads without stopping the pool
+     *
+     * @details Missing threads are started right away while surplus threads exit as soon as they
+     * are done with their current task. The count is limited to get_thread_capacity(), reset()
+     * goes beyond that. Elastic pools take the count as their new minimum and keep adding
+     * threads on load.
+     */
+    void set_thread_count( unsigned const count ) { ( *runtime_ ).set_thread_count( count ); }
+
+    /**
+     * @brief Returns if the pool has been paused
      */
     BE_NODISGARD bool is_paused() const noexcept { return ( *runtime_ ).paused_; }
 
@@ -283,7 +888,7 @@ public:
     /**
      * @brief Resumes the enqueueing of tasks in the pool
      */
-    void unpause() noexcept { ( *runtime_ ).paused_ = false; }
+    void unpause() noexcept { ( *runtime_ ).unpause(); }
 
     /**
      * @brief Part of the future-like api `get()` is simply an alias for `wait()`. As task_pools
@@ -298,6 +903,10 @@ public:
     /**
      * @brief Blocks calling thread until all tasks have completed. No tasked may be submitted while
      * pool is waiting. If called while paused the function does nothing to avoid deadlocks
+     *
+     * @details The calling thread runs queued tasks while it waits. Called from within a task it
+     * does not wait for the tasks running on its own stack, so tasks may wait for the tasks they
+     * submitted.
      */
     void wait() noexcept { ( *runtime_ ).wait(); }
 
@@ -320,9 +929,34 @@ public:
         return ( *runtime_ ).wait_until( std::forward< Timepoint >( x ) );
     }
     /**
-     * @brief Returns a stop token for the pool.
+     * @brief Returns a stop token for the pool which fires on abort() and destruction
+     */
+    stop_token get_stop_token() const noexcept { return ( *runtime_ ).abort_source_.get_token(); };
+
+    /**
+     * @brief Returns a copy of the allocator of the pool
+     */
+    BE_NODISGARD Allocator get_allocator() const noexcept { return allocator_; }
+
+    /**
+     * @brief Returns an awaitable that resumes the awaiting coroutine on a thread of the pool
+     *
+     * @details Requires C++20 and task_pool/coroutine.h. A template so explicit instantiations
+     * of the pool leave it out.
+     *
+     * @code{.cpp}
+     * be::task< int > work( be::task_pool& pool )
+     * {
+     *     co_await pool.schedule();
+     *     co_return compute();
+     * }
+     * @endcode
      */
-    stop_token get_stop_token() const noexcept { return stop_token{ ( *runtime_ ).abort_ }; };
+    template< typename Pool = task_pool_t >
+    schedule_awaiter< Pool > schedule( task_options options = {} )
+    {
+        return schedule_awaiter< Pool >( *this, std::move( options ) );
+    }
 
     /**
      * @brief Get the maximum duration used to wait prior to checking lazy input arguments
@@ -334,6 +968,65 @@ public:
         return ( *runtime_ ).task_check_latency_;
     }
 
+    /**
+     * @brief Returns how tasks are distributed between the threads of the pool
+     */
+    BE_NODISGARD schedule_policy get_schedule_policy() const noexcept
+    {
+        return ( *runtime_ ).scheduling_;
+    }
+
+    /**
+     * @brief Returns what threads without work do before they go to sleep
+     */
+    BE_NODISGARD idle_policy get_idle_policy() const noexcept { return ( *runtime_ ).idle_; }
+
+    /**
+     * @brief Returns whether threads are grouped by NUMA node
+     */
+    BE_NODISGARD numa_policy get_numa_policy() const noexcept { return ( *runtime_ ).numa_; }
+
+    /**
+     * @brief Returns the number of pending tasks at which the overflow policy applies, zero if
+     * there is no limit
+     */
+    BE_NODISGARD std::size_t get_queue_capacity() const noexcept
+    {
+        return ( *runtime_ ).queue_capacity_;
+    }
+
+    /**
+     * @brief Returns what submitting to a full pool does
+     */
+    BE_NODISGARD overflow_policy get_overflow_policy() const noexcept
+    {
+        return ( *runtime_ ).overflow_;
+    }
+
+    /**
+     * @brief Returns the granularity of the timers
+     */
+    BE_NODISGARD std::chrono::nanoseconds get_timer_resolution() const noexcept
+    {
+        return ( *runtime_ ).timer_resolution_;
+    }
+
+    /**
+     * @brief Returns the operating system settings of the threads
+     */
+    BE_NODISGARD thread_options const& get_thread_options() const noexcept
+    {
+        return ( *runtime_ ).thread_options_;
+    }
+
+    /**
+     * @brief Returns the number of NUMA node groups, zero unless grouping by node
+     */
+    BE_NODISGARD unsigned get_numa_nodes() const noexcept
+    {
+        return static_cast< unsigned >( ( *runtime_ ).node_queues_.size() );
+    }
+
     void invoke_deferred() { ( *runtime_ ).invoke_deferred(); }
 
     /**
@@ -344,7 +1037,7 @@ public:
      * @param args Parameter pack of input arguments to task
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename FuncType = std::remove_cv_t< std::remove_reference_t< Func > >,
@@ -354,17 +1047,18 @@ public:
                                     be::is_allocator_constructible< Promise< Return > >::value &&
                                     be_is_void_v< Return > && !wants_allocator_v< Func >,
                                 bool > = true >
-    Future submit( std::launch launch, Func&& task, Args&&... args )
+    Future submit( task_options options, Func&& task, Args&&... args )
     {
         Promise< Return > promise( std::allocator_arg_t{}, allocator_ );
         auto              task_future = promise.get_future();
         ( *runtime_ )
-            .push_task( launch,
+            .push_task( options,
                         make_task( [task_function = std::bind( std::forward< Func >( task ),
                                                                std::forward< Args >( args )... ),
                                     task_promise  = std::move( promise )]() mutable {
                             try
                             {
+                                pool_runtime::throw_if_cancelled();
                                 task_function();
                                 task_promise.set_value();
                             }
@@ -383,7 +1077,7 @@ public:
      * void( std::allocator_arg_t, Allocator<T> const&, ... )
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename FuncType = std::remove_cv_t< std::remove_reference_t< Func > >,
@@ -399,12 +1093,12 @@ public:
                                     be::is_allocator_constructible< Promise< Return > >::value &&
                                     be_is_void_v< Return > && wants_allocator_v< Func >,
                                 bool > = true >
-    Future submit( std::launch launch, Func&& task, Args&&... args )
+    Future submit( task_options options, Func&& task, Args&&... args )
     {
         auto promise     = Promise< Return >( std::allocator_arg_t{}, allocator_ );
         auto task_future = promise.get_future();
         ( *runtime_ )
-            .push_task( launch,
+            .push_task( options,
                         make_task( [task_function = std::bind( std::forward< Func >( task ),
                                                                std::allocator_arg_t{},
                                                                FunctionAllocator( allocator_ ),
@@ -412,6 +1106,7 @@ public:
                                     task_promise  = std::move( promise )]() mutable {
                             try
                             {
+                                pool_runtime::throw_if_cancelled();
                                 task_function();
                                 task_promise.set_value();
                             }
@@ -431,7 +1126,7 @@ public:
      * @param args A parameter pack of input arguments to task
      * @return Future<void>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename FuncType = std::remove_cv_t< std::remove_reference_t< Func > >,
@@ -449,20 +1144,21 @@ public:
                                     be_is_void_v< Return > && wants_stop_token_v< Func > &&
                                     wants_allocator_v< Func >,
                                 bool > = true >
-    Future submit( std::launch launch, Func&& task, Args&&... args )
+    Future submit( task_options options, Func&& task, Args&&... args )
     {
         auto promise     = Promise< Return >( std::allocator_arg_t{}, allocator_ );
         auto task_future = promise.get_future();
         ( *runtime_ )
-            .push_task( launch,
+            .push_task( options,
                         make_task( [task_function = std::bind( std::forward< Func >( task ),
                                                                std::allocator_arg_t{},
                                                                FunctionAllocator( allocator_ ),
                                                                std::forward< Args >( args )...,
-                                                               get_stop_token() ),
+                                                               task_token( options ) ),
                                     task_promise  = std::move( promise )]() mutable {
                             try
                             {
+                                pool_runtime::throw_if_cancelled();
                                 task_function();
                                 task_promise.set_value();
                             }
@@ -481,7 +1177,7 @@ public:
      * @param args A parameter pack of input arguments to task
      * @return Future<void>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename Return = be_invoke_result_t< std::decay_t< Func >, Args..., stop_token >,
@@ -491,18 +1187,19 @@ public:
                                     be_is_void_v< Return > && wants_stop_token_v< Func > &&
                                     !wants_allocator_v< Func >,
                                 bool > = true >
-    Future submit( std::launch launch, Func&& task, Args&&... args )
+    Future submit( task_options options, Func&& task, Args&&... args )
     {
         auto promise     = Promise< Return >( std::allocator_arg_t{}, allocator_ );
         auto task_future = promise.get_future();
         ( *runtime_ )
-            .push_task( launch,
+            .push_task( options,
                         make_task( [task_function = std::bind( std::forward< Func >( task ),
                                                                std::forward< Args >( args )...,
-                                                               get_stop_token() ),
+                                                               task_token( options ) ),
                                     task_promise  = std::move( promise )]() mutable {
                             try
                             {
+                                pool_runtime::throw_if_cancelled();
                                 task_function();
                                 task_promise.set_value();
                             }
@@ -521,7 +1218,7 @@ public:
      * @param args A parameter pack of input arguments to task
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename Return   = be_invoke_result_t< std::decay_t< Func >, Args... >,
@@ -532,17 +1229,18 @@ public:
                                     !be_is_void_v< Return > && !wants_allocator_v< Func > &&
                                     !wants_stop_token_v< Func >,
                                 bool > = true >
-    BE_NODISGARD Future submit( std::launch launch, Func&& task, Args&&... args )
+    BE_NODISGARD Future submit( task_options options, Func&& task, Args&&... args )
     {
         Promise< Return > promise( std::allocator_arg_t{}, allocator_ );
         auto              future = promise.get_future();
         ( *runtime_ )
-            .push_task( launch,
+            .push_task( options,
                         make_task( [task_function = std::bind( std::forward< Func >( task ),
                                                                std::forward< Args >( args )... ),
                                     task_promise  = std::move( promise )]() mutable {
                             try
                             {
+                                pool_runtime::throw_if_cancelled();
                                 task_promise.set_value( task_function() );
                             }
                             catch ( ... )
@@ -561,7 +1259,7 @@ public:
      * @param args A parameter pack with input arguments for task
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename FuncType = std::remove_reference_t< std::remove_cv_t< Func > >,
@@ -577,12 +1275,12 @@ public:
                                     be::is_allocator_constructible< Promise< Return > >::value &&
                                     !be_is_void_v< Return > && wants_allocator_v< Func >,
                                 bool > = true >
-    BE_NODISGARD Future submit( std::launch launch, Func&& task, Args&&... args )
+    BE_NODISGARD Future submit( task_options options, Func&& task, Args&&... args )
     {
         Promise< Return > promise( std::allocator_arg_t{}, allocator_ );
         auto              future = promise.get_future();
         ( *runtime_ )
-            .push_task( launch,
+            .push_task( options,
                         make_task( [task_function = std::bind( std::forward< Func >( task ),
                                                                std::allocator_arg_t{},
                                                                FunctionAllocator( allocator_ ),
@@ -590,6 +1288,7 @@ public:
                                     task_promise  = std::move( promise )]() mutable {
                             try
                             {
+                                pool_runtime::throw_if_cancelled();
                                 task_promise.set_value( task_function() );
                             }
                             catch ( ... )
@@ -608,7 +1307,7 @@ public:
      * @param args A parameter pack of input arguments to token
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename Return   = be_invoke_result_t< std::decay_t< Func >, Args..., stop_token >,
@@ -619,18 +1318,19 @@ public:
                                     !be_is_void_v< Return > && wants_stop_token_v< Func > &&
                                     !wants_allocator_v< Func >,
                                 bool > = true >
-    BE_NODISGARD Future submit( std::launch launch, Func&& task, Args&&... args )
+    BE_NODISGARD Future submit( task_options options, Func&& task, Args&&... args )
     {
         Promise< Return > promise( std::allocator_arg_t{}, allocator_ );
         auto              future = promise.get_future();
         ( *runtime_ )
-            .push_task( launch,
+            .push_task( options,
                         make_task( [task_function = std::bind( std::forward< Func >( task ),
                                                                std::forward< Args >( args )...,
-                                                               get_stop_token() ),
+                                                               task_token( options ) ),
                                     task_promise  = std::move( promise )]() mutable {
                             try
                             {
+                                pool_runtime::throw_if_cancelled();
                                 task_promise.set_value( task_function() );
                             }
                             catch ( ... )
@@ -650,7 +1350,7 @@ public:
      * @return Future<Return>
      */
 
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename FuncType = std::remove_reference_t< std::remove_cv_t< Func > >,
@@ -668,20 +1368,21 @@ public:
                                     !be_is_void_v< Return > && wants_stop_token_v< Func > &&
                                     wants_allocator_v< Func >,
                                 bool > = true >
-    BE_NODISGARD Future submit( std::launch launch, Func&& task, Args&&... args )
+    BE_NODISGARD Future submit( task_options options, Func&& task, Args&&... args )
     {
         Promise< Return > promise( std::allocator_arg_t{}, allocator_ );
         auto              future = promise.get_future();
         ( *runtime_ )
-            .push_task( launch,
+            .push_task( options,
                         make_task( [task_function = std::bind( std::forward< Func >( task ),
                                                                std::allocator_arg_t{},
                                                                FunctionAllocator( allocator_ ),
                                                                std::forward< Args >( args )...,
-                                                               get_stop_token() ),
+                                                               task_token( options ) ),
                                     task_promise  = std::move( promise )]() mutable {
                             try
                             {
+                                pool_runtime::throw_if_cancelled();
                                 task_promise.set_value( task_function() );
                             }
                             catch ( ... )
@@ -700,7 +1401,7 @@ public:
      * @param args A parameter pack containing one or more futures of values to task
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename Return = be_invoke_result_t< std::decay_t< Func >,
@@ -709,10 +1410,10 @@ public:
               std::enable_if_t< be::is_promise_v< Promise > &&
                                     contains_future< std::decay_t< Args >... >::value,
                                 bool > = true >
-    BE_NODISGARD Future submit( std::launch launch, Func&& task, Args&&... args )
+    BE_NODISGARD Future submit( task_options options, Func&& task, Args&&... args )
     {
         return make_defered_task(
-            launch,
+            options,
             Promise< Return >{ std::allocator_arg_t{}, allocator_ },
             std::forward< Func >( task ),
             std::make_tuple( wrap_future_argument( std::forward< Args >( args ) )... ) );
@@ -726,7 +1427,7 @@ public:
      * @param args A par
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename FuncType = std::remove_reference_t< std::remove_cv_t< Func > >,
@@ -742,7 +1443,7 @@ public:
                                     !wants_stop_token_v< Func > &&
                                     contains_future< std::decay_t< Args >... >::value,
                                 bool > = true >
-    BE_NODISGARD Future submit( std::launch launch, Func&& task, Args&&... args )
+    BE_NODISGARD Future submit( task_options options, Func&& task, Args&&... args )
     {
         // note that if task is a member function it can not be forwared the allocator
         // since we use arg0 for the allocator...member functions should likely tie
@@ -751,7 +1452,7 @@ public:
             std::make_tuple( wrap_future_argument( std::allocator_arg_t{} ),
                              wrap_future_argument( FunctionAllocator( allocator_ ) ),
                              wrap_future_argument( std::forward< Args >( args ) )... );
-        return make_defered_task( launch,
+        return make_defered_task( options,
                                   Promise< Return >{ std::allocator_arg_t{}, allocator_ },
                                   std::forward< Func >( task ),
                                   std::move( args_tuple ) );
@@ -765,7 +1466,7 @@ public:
      * @param args A parameter pack cont,aining one or more futures of values to task
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename FuncType = std::remove_reference_t< std::remove_cv_t< Func > >,
@@ -782,7 +1483,7 @@ public:
                                     wants_stop_token_v< Func > &&
                                     contains_future< std::decay_t< Args >... >::value,
                                 bool > = true >
-    BE_NODISGARD Future submit( std::launch launch, Func&& task, Args&&... args )
+    BE_NODISGARD Future submit( task_options options, Func&& task, Args&&... args )
     {
         // note that if task is a member function it can not be forwared the allocator
         // since we use arg0 for the allocator...member functions should likely tie
@@ -790,8 +1491,8 @@ public:
         auto args_tuple = std::make_tuple( wrap_future_argument( std::allocator_arg_t{} ),
                                            wrap_future_argument( FunctionAllocator( allocator_ ) ),
                                            wrap_future_argument( std::forward< Args >( args ) )...,
-                                           wrap_future_argument( get_stop_token() ) );
-        return make_defered_task( launch,
+                                           wrap_future_argument( task_token( options ) ) );
+        return make_defered_task( options,
                                   Promise< Return >{ std::allocator_arg_t{}, allocator_ },
                                   std::forward< Func >( task ),
                                   std::move( args_tuple ) );
@@ -805,7 +1506,7 @@ public:
      * @param args A parameter pack cont,aining one or more futures of values to task
      * @return Future<Return>
      */
-    template< template< typename > class Promise = std::promise,
+    template< template< typename > class Promise = notifying_promise,
               typename Func,
               typename... Args,
               typename Return = be_invoke_result_t< std::decay_t< Func >,
@@ -816,538 +1517,3129 @@ public:
                                     wants_stop_token_v< Func > &&
                                     contains_future< std::decay_t< Args >... >::value,
                                 bool > = true >
-    BE_NODISGARD Future submit( std::launch launch, Func&& task, Args&&... args )
+    BE_NODISGARD Future submit( task_options options, Func&& task, Args&&... args )
     {
         auto args_tuple = std::make_tuple( wrap_future_argument( std::forward< Args >( args ) )...,
-                                           wrap_future_argument( get_stop_token() ) );
-        return make_defered_task( launch,
+                                           wrap_future_argument( task_token( options ) ) );
+        return make_defered_task( options,
                                   Promise< Return >{ std::allocator_arg_t{}, allocator_ },
                                   std::forward< Func >( task ),
                                   std::move( args_tuple ) );
     }
 
-private:
     /**
-     * @brief Task storage with type erasure
+     * @brief Submits a task unless the pool is at its queue capacity
+     *
+     * @details Takes the same arguments as submit. Instead of applying the overflow policy a task
+     * that does not fit is discarded and an invalid future returned, check it with valid().
+     *
+     * @code{.cpp}
+     * auto reply = pool.try_submit( std::launch::async, &handle_request, request );
+     * if ( !reply.valid() )
+     * {
+     *     respond_busy( request );
+     * }
+     * @endcode
      */
-    struct TASKPOOL_HIDDEN task_proxy
+    template< template< typename > class Promise = notifying_promise,
+              typename Func,
+              typename... Args >
+    BE_NODISGARD auto try_submit( task_options options, Func&& task, Args&&... args )
+        -> decltype( std::declval< task_pool_t& >().template submit< Promise >(
+            options, std::forward< Func >( task ), std::forward< Args >( args )... ) )
     {
-        bool ( *check_task )( void* );
-        void ( *execute_task )( void* );
-        std::unique_ptr< void, void ( * )( void* ) > storage;
-
-        task_proxy() = delete;
-
-        /**
-         * @brief Constructs a proxy around a task with allocator support
-         */
-        template< typename Task >
-        explicit task_proxy( Task* task )
-            : check_task( []( void* x ) { return ( *static_cast< Task* >( x ) ).is_ready(); } )
-            , execute_task( []( void* x ) { ( *static_cast< Task* >( x ) )(); } )
-            , storage( task, []( void* x ) {
-                Task* tsk = static_cast< Task* >( x );
-                std::allocator_traits< decltype( tsk->alloc ) >::destroy( tsk->alloc, tsk );
-                std::allocator_traits< decltype( tsk->alloc ) >::deallocate( tsk->alloc, tsk, 1 );
-            } )
-        {
-        }
-        ~task_proxy()                   = default;
-        task_proxy( task_proxy const& ) = delete;
-        task_proxy& operator=( task_proxy const& ) = delete;
-        task_proxy( task_proxy&& other ) noexcept
-            : check_task( other.check_task )
-            , execute_task( other.execute_task )
-            , storage( std::move( other.storage ) )
+        struct trying_scope
         {
-            other.execute_task = nullptr;
-            other.check_task   = nullptr;
-        }
-        task_proxy& operator=( task_proxy&& other ) noexcept
+            typename pool_runtime::worker_context& worker;
+            ~trying_scope() { worker.trying = false; }
+        };
+        auto& worker    = pool_runtime::this_worker();
+        worker.trying   = true;
+        worker.rejected = false;
+        trying_scope const scope{ worker };
+        auto               future = submit< Promise >(
+            options, std::forward< Func >( task ), std::forward< Args >( args )... );
+        if ( worker.rejected )
         {
-            check_task         = other.check_task;
-            execute_task       = other.execute_task;
-            storage            = std::move( other.storage );
-            other.execute_task = nullptr;
-            other.check_task   = nullptr;
-            return *this;
+            return decltype( future ){};
         }
-    };
+        return future;
+    }
 
     /**
-     * @brief Creates a task from some callable as a new type with allocator
-     * support
+     * @brief Runs a task once the delay has passed
+     *
+     * @details Timers are fire and forget, there is no future and exceptions thrown by the task
+     * are discarded. The task is queued when the timer expires, never before delay has passed,
+     * taking the priority and stop token of options while the launch policy is ignored. Tasks
+     * that take a be::stop_token are given one that fires when the timer is cancelled or the pool
+     * aborts. Timers that have not expired do not keep wait() from returning and are dropped by
+     * reset(), abort() and destruction.
+     *
+     * @code{.cpp}
+     * auto timeout = pool.submit_after( 5s, [&connection] { connection.close(); } );
+     * timeout.cancel(); // the reply arrived in time
+     * @endcode
+     *
+     * @return A handle cancelling the timer
      */
-    template< typename Func,
-              typename FuncType = std::remove_reference_t< std::remove_cv_t< Func > > >
-    auto make_task( Func&& task )
+    template< typename Rep, typename Period, typename Func, typename... Args >
+    timer_handle submit_after( task_options                                options,
+                               std::chrono::duration< Rep, Period > const& delay,
+                               Func&&                                      task,
+                               Args&&... args )
     {
-        struct TASKPOOL_HIDDEN Task : FuncType
-        {
-            using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
-            Task( TaskAllocator const& a, Func&& f )
-                : FuncType( std::forward< Func >( f ) )
-                , alloc( a )
-            {
-            }
-            using FuncType::operator();
-            static bool     is_ready() { return true; }
-            TaskAllocator   alloc;
-            ~Task()             = default;
-            Task( Task const& ) = delete;
-            Task& operator=( Task const& ) = delete;
-            Task( Task&& ) noexcept        = delete;
-            Task& operator=( Task&& ) = delete;
-        };
+        return add_timer( std::move( options ),
+                          std::chrono::steady_clock::now() +
+                              std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+                                  delay ),
+                          std::chrono::nanoseconds( 0 ),
+                          std::forward< Func >( task ),
+                          std::forward< Args >( args )... );
+    }
 
-        typename Task::TaskAllocator task_allocator( allocator_ );
-        Task*                        typed_task =
-            std::allocator_traits< typename Task::TaskAllocator >::allocate( task_allocator, 1 );
-        std::allocator_traits< typename Task::TaskAllocator >::construct(
-            task_allocator, typed_task, task_allocator, std::forward< Func >( task ) );
-        return task_proxy( typed_task );
+    template< typename Rep, typename Period, typename Func, typename... Args >
+    timer_handle
+    submit_after( std::chrono::duration< Rep, Period > const& delay, Func&& task, Args&&... args )
+    {
+        return submit_after(
+            task_options{}, delay, std::forward< Func >( task ), std::forward< Args >( args )... );
     }
 
-    template< class Promise,
+    /**
+     * @brief Runs a task once the time has come, see submit_after
+     *
+     * @details Time points of clocks other than std::chrono::steady_clock are converted to it
+     * when the timer is added, later adjustments of their clock are not followed.
+     */
+    template< typename Clock, typename Duration, typename Func, typename... Args >
+    timer_handle submit_at( task_options                                        options,
+                            std::chrono::time_point< Clock, Duration > const& time,
+                            Func&&                                              task,
+                            Args&&... args )
+    {
+        return add_timer( std::move( options ),
+                          steady_time( time ),
+                          std::chrono::nanoseconds( 0 ),
+                          std::forward< Func >( task ),
+                          std::forward< Args >( args )... );
+    }
+
+    template< typename Clock, typename Duration, typename Func, typename... Args >
+    timer_handle
+    submit_at( std::chrono::time_point< Clock, Duration > const& time, Func&& task, Args&&... args )
+    {
+        return submit_at(
+            task_options{}, time, std::forward< Func >( task ), std::forward< Args >( args )... );
+    }
+
+    /**
+     * @brief Runs a task every period until the timer is cancelled, see submit_after
+     *
+     * @details The first run is one period from now. Expiries are counted from the first one so
+     * runs do not drift, expiries that were missed are skipped rather than run late and an expiry
+     * is skipped while the run of the previous one has not returned.
+     *
+     * @code{.cpp}
+     * auto flush = pool.submit_every( 100ms, [&log] { log.flush(); } );
+     * @endcode
+     */
+    template< typename Rep, typename Period, typename Func, typename... Args >
+    timer_handle submit_every( task_options                                options,
+                               std::chrono::duration< Rep, Period > const& period,
+                               Func&&                                      task,
+                               Args&&... args )
+    {
+        auto const interval =
+            std::max( std::chrono::duration_cast< std::chrono::nanoseconds >( period ),
+                      std::chrono::nanoseconds( 1 ) );
+        return add_timer( std::move( options ),
+                          std::chrono::steady_clock::now() + interval,
+                          interval,
+                          std::forward< Func >( task ),
+                          std::forward< Args >( args )... );
+    }
+
+    template< typename Rep, typename Period, typename Func, typename... Args >
+    timer_handle
+    submit_every( std::chrono::duration< Rep, Period > const& period, Func&& task, Args&&... args )
+    {
+        return submit_every(
+            task_options{}, period, std::forward< Func >( task ), std::forward< Args >( args )... );
+    }
+
+    /**
+     * @brief Adds one task per element of [first, last) returning the futures in the same order
+     *
+     * @details Every task is created before any is queued and all are queued with a single lock
+     * acquisition. At most one sleeping thread per task is woken. Each task holds a copy of task
+     * and of its element.
+     *
+     * @param options Launch policy, priority, stop token and deadline of every task
+     * @param first A forward iterator to the first element
+     * @param last A forward iterator one past the last element
+     * @param task A callable value type
+     * Return( Element& )
+     * @return std::vector<Future<Return>>
+     */
+    template< template< typename > class Promise = notifying_promise,
+              typename Iterator,
               typename Func,
-              typename ArgsTuple,
-              typename Future = promise_api::get_future_t< Promise >,
-              typename Return = future_api::get_result_t< Future >,
-              std::enable_if_t<
-                  std::is_class< std::remove_reference_t< std::remove_cv_t< Func > > >::value,
-                  bool > = true >
+              typename Element = typename std::iterator_traits< Iterator >::value_type,
+              typename Return  = be_invoke_result_t< std::decay_t< Func >, Element& >,
+              typename Future  = decltype( std::declval< Promise< Return > >().get_future() ),
+              std::enable_if_t< be::is_promise_v< Promise > &&
+                                    be::is_allocator_constructible< Promise< Return > >::value,
+                                bool > = true >
+    BE_NODISGARD std::vector< Future >
+    submit_bulk( task_options options, Iterator first, Iterator last, Func&& task )
+    {
+        auto const count = static_cast< std::size_t >( std::distance( first, last ) );
+        return submit_batch< Promise, Return >( std::move( options ),
+                                                count,
+                                                std::forward< Func >( task ),
+                                                [&first]() -> Element { return *first++; } );
+    }
 
-    Future
-    make_defered_task( std::launch launch, Promise promise, Func&& task, ArgsTuple args_tuple )
+    template< template< typename > class Promise = notifying_promise,
+              typename Iterator,
+              typename Func,
+              typename Element = typename std::iterator_traits< Iterator >::value_type,
+              typename Return  = be_invoke_result_t< std::decay_t< Func >, Element& >,
+              typename Future  = decltype( std::declval< Promise< Return > >().get_future() ),
+              std::enable_if_t< be::is_promise_v< Promise > &&
+                                    be::is_allocator_constructible< Promise< Return > >::value,
+                                bool > = true >
+    BE_NODISGARD std::vector< Future > submit_bulk( Iterator first, Iterator last, Func&& task )
     {
-        using FuncType = std::remove_reference_t< std::remove_cv_t< Func > >;
-        struct TASKPOOL_HIDDEN Task : FuncType
+        return submit_bulk< Promise >( task_options{}, first, last, std::forward< Func >( task ) );
+    }
+
+    /**
+     * @brief Adds count tasks calling task with the indices [0, count) returning the futures in
+     * index order
+     *
+     * @details See submit_bulk
+     *
+     * @param options Launch policy, priority, stop token and deadline of every task
+     * @param count The number of tasks
+     * @param task A callable value type
+     * Return( std::size_t )
+     * @return std::vector<Future<Return>>
+     */
+    template< template< typename > class Promise = notifying_promise,
+              typename Func,
+              typename Return = be_invoke_result_t< std::decay_t< Func >, std::size_t& >,
+              typename Future = decltype( std::declval< Promise< Return > >().get_future() ),
+              std::enable_if_t< be::is_promise_v< Promise > &&
+                                    be::is_allocator_constructible< Promise< Return > >::value,
+                                bool > = true >
+    BE_NODISGARD std::vector< Future >
+    submit_n( task_options options, std::size_t const count, Func&& task )
+    {
+        std::size_t index = 0;
+        return submit_batch< Promise, Return >( std::move( options ),
+                                                count,
+                                                std::forward< Func >( task ),
+                                                [&index]() { return index++; } );
+    }
+
+    template< template< typename > class Promise = notifying_promise,
+              typename Func,
+              typename Return = be_invoke_result_t< std::decay_t< Func >, std::size_t& >,
+              typename Future = decltype( std::declval< Promise< Return > >().get_future() ),
+              std::enable_if_t< be::is_promise_v< Promise > &&
+                                    be::is_allocator_constructible< Promise< Return > >::value,
+                                bool > = true >
+    BE_NODISGARD std::vector< Future > submit_n( std::size_t const count, Func&& task )
+    {
+        return submit_n< Promise >( task_options{}, count, std::forward< Func >( task ) );
+    }
+
+    /**
+     * @brief Adds a task calling func with the value of future once it is ready
+     *
+     * @details Futures that can notify, be::future and be::notifying_future, park the task until
+     * their producer completes so no thread polls or blocks on them. Other futures are polled
+     * like lazy arguments. func takes no argument if future has no value.
+     *
+     * @code{.cpp}
+     * auto image     = pool.submit< be::promise >( std::launch::async, &load, path );
+     * auto thumbnail = pool.then( std::move( image ), &scale_down );
+     * @endcode
+     *
+     * @return be::future<Return>
+     */
+    template< typename Future,
+              typename Func,
+              typename FutureType = std::decay_t< Future >,
+              typename FuncType   = std::decay_t< Func >,
+              typename Return     = decltype( detail::invoke_continuation(
+                  std::declval< FuncType& >(), std::declval< FutureType& >() ) ),
+              std::enable_if_t< is_future< FutureType >::value, bool > = true >
+    BE_NODISGARD be::future< Return > then( Future&& future, Func&& func )
+    {
+        struct TASKPOOL_HIDDEN Task
         {
             using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
 
-            TaskAllocator alloc;
-            Promise       promise_;
-            ArgsTuple     arguments_;
-            Task( TaskAllocator const& a, Promise&& p, Func&& f, ArgsTuple&& arg )
-                : FuncType( std::forward< Func >( f ) )
-                , alloc( a )
+            TaskAllocator         alloc;
+            be::promise< Return > promise_;
+            FuncType              func_;
+            FutureType            future_;
+            Task( TaskAllocator const& a, be::promise< Return >&& p, Func&& f, Future&& x )
+                : alloc( a )
                 , promise_( std::move( p ) )
-                , arguments_( std::move( arg ) )
+                , func_( std::forward< Func >( f ) )
+                , future_( std::forward< Future >( x ) )
             {
             }
 
             bool is_ready() const
             {
-                return check_argument_status(
-                    arguments_, std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+                return future_.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready;
             }
-            auto operator()()
+            void operator()()
             {
+                auto invoke = [this]( FutureType& input ) {
+                    return detail::invoke_continuation( func_, input );
+                };
                 try
                 {
-                    invoke_deferred_task(
-                        promise_,
-                        std::mem_fn( &FuncType::operator() ),
-                        this,
-                        arguments_,
-                        std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+                    fulfill_promise( promise_, invoke, future_ );
                 }
                 catch ( ... )
                 {
                     promise_.set_exception( std::current_exception() );
                 }
             }
-            ~Task()             = default;
-            Task( Task const& ) = delete;
-            Task& operator=( Task const& ) = delete;
-            Task( Task&& ) noexcept        = delete;
-            Task& operator=( Task&& ) = delete;
         };
-        auto                         future = promise.get_future();
-        typename Task::TaskAllocator task_allocator( allocator_ );
-        Task*                        typed_task =
-            std::allocator_traits< typename Task::TaskAllocator >::allocate( task_allocator, 1 );
-        std::allocator_traits< typename Task::TaskAllocator >::construct(
-            task_allocator,
-            typed_task,
-            task_allocator,
-            std::move( promise ),
-            std::forward< Func >( task ),
-            std::move( args_tuple ) );
-        ( *runtime_ ).push_task( launch, task_proxy( typed_task ) );
-        return future;
+        be::promise< Return > promise( std::allocator_arg_t{}, allocator_ );
+        auto                  result = promise.get_future();
+        task_proxy            proxy( typename task_proxy::template task_type< Task >{},
+                                     typename Task::TaskAllocator( allocator_ ),
+                                     std::move( promise ),
+                                     std::forward< Func >( func ),
+                                     std::forward< Future >( future ) );
+        if ( future_api::is_notifying< FutureType >::value )
+        {
+            ( *runtime_ ).park_task(
+                std::move( proxy ), 1U, []( void* x, continuation const& next ) {
+                    if ( !detail::subscribe_future( static_cast< Task* >( x )->future_, next ) )
+                    {
+                        next();
+                    }
+                } );
+        }
+        else
+        {
+            ( *runtime_ ).push_task( std::launch::async, std::move( proxy ) );
+        }
+        return result;
     }
 
-    template< class Promise,
-              typename Func,
-              typename ArgsTuple,
-              typename Future = promise_api::get_future_t< Promise >,
-              typename Return = future_api::get_result_t< Future >,
-              std::enable_if_t< be::is_function_pointer_v< Func >, bool > = true >
-    Future
-    make_defered_task( std::launch launch, Promise promise, Func&& task, ArgsTuple args_tuple )
+    /**
+     * @brief Returns a future for the values of all futures in order, or the first exception
+     * among them, that is satisfied once the last of them is ready
+     *
+     * @details The futures are collected by a task that is parked until every future has notified
+     * that it is ready. A vector of be::future< void > gives a be::future< void >.
+     */
+    template< typename T >
+    BE_NODISGARD be::future< detail::when_all_result_t< T > >
+    when_all( std::vector< be::future< T > > futures )
     {
+        using Result  = detail::when_all_result_t< T >;
+        using Futures = std::vector< be::future< T > >;
         struct TASKPOOL_HIDDEN Task
         {
             using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
 
-            TaskAllocator alloc;
-            Func          func_;
-            Promise       promise_;
-            ArgsTuple     arguments_;
-            Task( TaskAllocator const& a, Promise&& p, Func&& f, ArgsTuple&& arg )
+            TaskAllocator         alloc;
+            be::promise< Result > promise_;
+            Futures               futures_;
+            Task( TaskAllocator const& a, be::promise< Result >&& p, Futures&& f )
                 : alloc( a )
-                , func_( f )
                 , promise_( std::move( p ) )
-                , arguments_( std::move( arg ) )
+                , futures_( std::move( f ) )
             {
             }
 
             bool is_ready() const
             {
-                return check_argument_status(
-                    arguments_, std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+                return std::all_of( futures_.begin(), futures_.end(), []( auto const& future ) {
+                    return future.wait_for( std::chrono::seconds( 0 ) ) ==
+                           std::future_status::ready;
+                } );
             }
-            auto operator()()
+            void operator()()
             {
                 try
                 {
-                    invoke_deferred_task(
-                        promise_,
-                        func_,
-                        arguments_,
-                        std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+                    detail::fulfill_all( promise_, futures_ );
                 }
                 catch ( ... )
                 {
                     promise_.set_exception( std::current_exception() );
                 }
             }
-            ~Task()             = default;
-            Task( Task const& ) = delete;
-            Task& operator=( Task const& ) = delete;
-            Task( Task&& ) noexcept        = delete;
-            Task& operator=( Task&& ) = delete;
         };
-        auto                         future = promise.get_future();
-        typename Task::TaskAllocator task_allocator( allocator_ );
-        Task*                        typed_task =
-            std::allocator_traits< typename Task::TaskAllocator >::allocate( task_allocator, 1 );
-        std::allocator_traits< typename Task::TaskAllocator >::construct(
-            task_allocator,
-            typed_task,
-            task_allocator,
-            std::move( promise ),
-            std::forward< Func >( task ),
-            std::move( args_tuple ) );
-        ( *runtime_ ).push_task( launch, task_proxy( typed_task ) );
+        be::promise< Result > promise( std::allocator_arg_t{}, allocator_ );
+        auto                  future = promise.get_future();
+        std::size_t const     count  = futures.size();
+        ( *runtime_ ).park_task( task_proxy( typename task_proxy::template task_type< Task >{},
+                                             typename Task::TaskAllocator( allocator_ ),
+                                             std::move( promise ),
+                                             std::move( futures ) ),
+                                 count,
+                                 []( void* x, continuation const& next ) {
+                                     for ( auto& input : static_cast< Task* >( x )->futures_ )
+                                     {
+                                         if ( !input.set_continuation( next ) )
+                                         {
+                                             next();
+                                         }
+                                     }
+                                 } );
         return future;
     }
 
-    template< class Promise,
-              typename Func,
-              typename ArgsTuple,
-              typename Future = promise_api::get_future_t< Promise >,
-              typename Return = future_api::get_result_t< Future >,
-              std::enable_if_t< std::is_member_function_pointer< Func >::value, bool > = true >
+    /**
+     * @brief Returns a future that is satisfied with the futures and the index of the first of
+     * them that became ready
+     *
+     * @details The result is produced by a task that is queued by the first future to notify.
+     */
+    template< typename T >
+    BE_NODISGARD be::future< when_any_result< std::vector< be::future< T > > > >
+    when_any( std::vector< be::future< T > > futures )
+    {
+        return park_when_any( std::move( futures ) );
+    }
 
-    Future make_defered_task( std::launch launch, Promise promise, Func task, ArgsTuple args_tuple )
+    template< typename... Ts >
+    BE_NODISGARD be::future< when_any_result< std::tuple< be::future< Ts >... > > >
+    when_any( std::tuple< be::future< Ts >... > futures )
     {
-        struct TASKPOOL_HIDDEN Task
-        {
-            using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
+        return park_when_any( std::move( futures ) );
+    }
 
-            TaskAllocator alloc;
-            Func          func_;
-            Promise       promise_;
-            ArgsTuple     arguments_;
-            Task( TaskAllocator const& a, Promise&& p, Func f, ArgsTuple&& arg )
-                : alloc( a )
-                , func_( f )
+private:
+    friend class task_group_t< Allocator, ReadyQueue >;
+    friend class schedule_awaiter< task_pool_t >;
+
+    /**
+     * @brief Queues a function past the queue capacity and launch policy, used to resume
+     * coroutines which must never run on the thread suspending them
+     */
+    template< typename Func >
+    void post( task_options options, Func&& func )
+    {
+        auto& runtime  = *runtime_;
+        auto  proxy    = make_task( std::forward< Func >( func ) );
+        proxy.priority = runtime.level_of( options.priority );
+        proxy.stop     = std::move( options.stop );
+        proxy.deadline = options.deadline;
+        runtime.queue_task( std::launch::async, std::move( proxy ) );
+    }
+
+    /**
+     * @brief Function of a periodic timer shared by the tasks of its expiries
+     */
+    template< typename Function >
+    struct periodic_function
+    {
+        Function         function;
+        std::atomic_bool running{ false }; // by the task of an earlier expiry
+
+        explicit periodic_function( Function&& f )
+            : function( std::move( f ) )
+        {
+        }
+
+        void operator()()
+        {
+            if ( running.exchange( true ) )
+            {
+                return;
+            }
+            try
+            {
+                pool_runtime::throw_if_cancelled();
+                function();
+            }
+            catch ( ... ) // NOLINT (bugprone-empty-catch)
+            {
+                // timers have no future to report to
+            }
+            running = false;
+        }
+    };
+
+    template< typename Func,
+              typename... Args,
+              std::enable_if_t< !wants_stop_token_v< std::decay_t< Func > >, bool > = true >
+    static auto bind_timer_task( stop_token const& /*token*/, Func&& task, Args&&... args )
+    {
+        return std::bind( std::forward< Func >( task ), std::forward< Args >( args )... );
+    }
+
+    template< typename Func,
+              typename... Args,
+              std::enable_if_t< wants_stop_token_v< std::decay_t< Func > >, bool > = true >
+    static auto bind_timer_task( stop_token const& token, Func&& task, Args&&... args )
+    {
+        return std::bind( std::forward< Func >( task ), std::forward< Args >( args )..., token );
+    }
+
+    /**
+     * @brief Creates the tasks of a timer and hands it to the runtime
+     *
+     * @details The handle owns a stop_source of its own, a stop token in the options is forwarded
+     * to it by a stop_callback living as long as the timer.
+     */
+    template< typename Func, typename... Args >
+    timer_handle add_timer( task_options                                options,
+                            std::chrono::steady_clock::time_point const due,
+                            std::chrono::nanoseconds const              period,
+                            Func&&                                      task,
+                            Args&&... args )
+    {
+        auto&                         runtime = *runtime_;
+        stop_source                   source;
+        typename pool_runtime::timer  entry;
+        entry.stop     = source.get_token().chain( get_stop_token() );
+        entry.priority = runtime.level_of( options.priority );
+        if ( options.stop.stop_possible() )
+        {
+            entry.forward = std::make_shared< stop_callback< std::function< void() > > >(
+                options.stop, [source]() mutable { source.request_stop(); } );
+        }
+        auto bound = bind_timer_task(
+            entry.stop, std::forward< Func >( task ), std::forward< Args >( args )... );
+        if ( period == std::chrono::nanoseconds( 0 ) )
+        {
+            entry.task = make_task( [function = std::move( bound )]() mutable {
+                try
+                {
+                    pool_runtime::throw_if_cancelled();
+                    function();
+                }
+                catch ( ... ) // NOLINT (bugprone-empty-catch)
+                {
+                    // timers have no future to report to
+                }
+            } );
+        }
+        else
+        {
+            auto shared = std::make_shared< periodic_function< decltype( bound ) > >(
+                std::move( bound ) );
+            // pools may be moved, the tasks of later expiries are made with a copy of the
+            // allocator
+            entry.repeat = [alloc = allocator_, shared] {
+                return make_task( alloc, [shared] { ( *shared )(); } );
+            };
+        }
+        runtime.add_timer( due, period, std::move( entry ) );
+        return timer_handle( std::move( source ) );
+    }
+
+    template< typename Clock, typename Duration >
+    static std::chrono::steady_clock::time_point
+    steady_time( std::chrono::time_point< Clock, Duration > const& time )
+    {
+        return std::chrono::steady_clock::now() +
+               std::chrono::duration_cast< std::chrono::steady_clock::duration >( time -
+                                                                                  Clock::now() );
+    }
+
+    template< typename Duration >
+    static std::chrono::steady_clock::time_point
+    steady_time( std::chrono::time_point< std::chrono::steady_clock, Duration > const& time )
+    {
+        return std::chrono::time_point_cast< std::chrono::steady_clock::duration >( time );
+    }
+
+    /**
+     * @brief The token handed to a task, fires with the token of its options or the pool
+     */
+    stop_token task_token( task_options const& options ) const
+    {
+        return options.stop.chain( get_stop_token() );
+    }
+
+    template< typename Futures >
+    be::future< when_any_result< Futures > > park_when_any( Futures futures )
+    {
+        using Result = when_any_result< Futures >;
+        struct TASKPOOL_HIDDEN Task
+        {
+            using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
+
+            TaskAllocator                             alloc;
+            be::promise< Result >                     promise_;
+            std::unique_ptr< detail::when_any_state > state_;
+            Futures                                   futures_; // detached before state_ is freed
+            Task( TaskAllocator const& a, be::promise< Result >&& p, Futures&& f )
+                : alloc( a )
                 , promise_( std::move( p ) )
-                , arguments_( std::move( arg ) )
+                , state_( std::make_unique< detail::when_any_state >( detail::future_count( f ) ) )
+                , futures_( std::move( f ) )
             {
             }
 
-            bool is_ready() const
+            bool is_ready() { return state_->fired_; }
+            void subscribe( continuation const& next )
             {
-                return check_argument_status(
-                    arguments_, std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+                state_->next_ = next;
+                if ( state_->slots_.empty() )
+                {
+                    next();
+                    return;
+                }
+                detail::for_each_future( futures_, [this]( auto& future, std::size_t index ) {
+                    continuation const ready{ &detail::when_any_state::ready,
+                                              &state_->slots_[index] };
+                    if ( !future.set_continuation( ready ) )
+                    {
+                        ready();
+                    }
+                } );
             }
-            auto operator()()
+            void operator()()
             {
+                detail::for_each_future( futures_, []( auto& future, std::size_t /*index*/ ) {
+                    future.reset_continuation();
+                } );
+                promise_.set_value( Result{ state_->index_, std::move( futures_ ) } );
+            }
+        };
+        be::promise< Result > promise( std::allocator_arg_t{}, allocator_ );
+        auto                  future = promise.get_future();
+        ( *runtime_ ).park_task( task_proxy( typename task_proxy::template task_type< Task >{},
+                                             typename Task::TaskAllocator( allocator_ ),
+                                             std::move( promise ),
+                                             std::move( futures ) ),
+                                 1U,
+                                 []( void* x, continuation const& next ) {
+                                     static_cast< Task* >( x )->subscribe( next );
+                                 } );
+        return future;
+    }
+
+    /**
+     * @brief Creates count tasks calling task with the values returned by next and queues them
+     * together
+     */
+    template< template< typename > class Promise,
+              typename Return,
+              typename Func,
+              typename Next,
+              typename Future = decltype( std::declval< Promise< Return > >().get_future() ) >
+    std::vector< Future >
+    submit_batch( task_options options, std::size_t const count, Func&& task, Next next )
+    {
+        std::vector< Future >     futures;
+        std::vector< task_proxy > proxies;
+        futures.reserve( count );
+        proxies.reserve( count );
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            Promise< Return > promise( std::allocator_arg_t{}, allocator_ );
+            futures.push_back( promise.get_future() );
+            proxies.push_back( make_task( [task_function = std::decay_t< Func >( task ),
+                                           argument      = next(),
+                                           task_promise  = std::move( promise )]() mutable {
                 try
                 {
-                    auto self = std::get< 0 >( arguments_ )();
-                    auto args = tail( arguments_ );
-                    invoke_deferred_task(
-                        promise_,
-                        std::mem_fn( func_ ),
-                        self,
-                        args,
-                        std::make_index_sequence< std::tuple_size< decltype( args ) >{} >{} );
+                    pool_runtime::throw_if_cancelled();
+                    fulfill_promise( task_promise, task_function, argument );
                 }
                 catch ( ... )
                 {
-                    promise_.set_exception( std::current_exception() );
+                    task_promise.set_exception( std::current_exception() );
                 }
+            } ) );
+        }
+        ( *runtime_ ).push_ready_tasks( options, proxies );
+        return futures;
+    }
+
+    template< typename Promise,
+              typename Func,
+              typename Argument,
+              std::enable_if_t< be_is_void_v< future_api::get_result_t<
+                                    promise_api::get_future_t< Promise > > >,
+                                bool > = true >
+    static void fulfill_promise( Promise& promise, Func& func, Argument& argument )
+    {
+        func( argument );
+        promise.set_value();
+    }
+
+    template< typename Promise,
+              typename Func,
+              typename Argument,
+              std::enable_if_t< !be_is_void_v< future_api::get_result_t<
+                                    promise_api::get_future_t< Promise > > >,
+                                bool > = true >
+    static void fulfill_promise( Promise& promise, Func& func, Argument& argument )
+    {
+        promise.set_value( func( argument ) );
+    }
+
+    /**
+     * @brief Task storage with type erasure
+     *
+     * @details Tasks that fit into `BE_TASK_INLINE_SIZE` bytes and can be moved without throwing
+     * are constructed directly in the proxy and moved along with it. Larger tasks are allocated
+     * through the rebound pool allocator and the proxy only holds a pointer to them.
+     */
+    struct TASKPOOL_HIDDEN task_proxy
+    {
+        static constexpr std::size_t inline_size = BE_TASK_INLINE_SIZE;
+
+        template< typename Task >
+        struct task_type
+        {
+        };
+
+        /**
+         * @brief Returns true if the task would be stored inside the proxy
+         */
+        template< typename Task >
+        static constexpr bool is_inline()
+        {
+            return sizeof( Task ) <= inline_size && alignof( Task ) <= alignof( std::max_align_t ) &&
+                   std::is_nothrow_move_constructible< Task >::value;
+        }
+
+        bool ( *check_task )( void* );
+        void ( *execute_task )( void* );
+        void ( *relocate_task )( void*, void* ); // null for tasks that are not inline
+        void ( *destroy_task )( void* );
+        void* task;
+        typename std::aligned_storage< inline_size, alignof( std::max_align_t ) >::type buffer;
+
+        unsigned            priority; // priority level the task is queued at
+        detail::stats_timer queued;   // empty without stats
+        stop_token          stop;     // the task is cancelled if it fires before the task runs
+
+        // the task is cancelled with be::deadline_exceeded if this passed before the task runs
+        std::chrono::steady_clock::time_point deadline;
+
+        /**
+         * @brief Constructs an empty proxy for the ready queues to move a task into
+         */
+        task_proxy() noexcept
+            : check_task( nullptr )
+            , execute_task( nullptr )
+            , relocate_task( nullptr )
+            , destroy_task( nullptr )
+            , task( nullptr )
+            , buffer()
+            , priority( 0U )
+            , queued()
+            , deadline( std::chrono::steady_clock::time_point::max() )
+        {
+        }
+
+        /**
+         * @brief Constructs a task in the proxy or through the given allocator
+         */
+        template< typename Task, typename TaskAllocator, typename... Args >
+        task_proxy( task_type< Task > /*type*/, TaskAllocator alloc, Args&&... args )
+            : check_task( []( void* x ) { return ( *static_cast< Task* >( x ) ).is_ready(); } )
+            , execute_task( []( void* x ) { ( *static_cast< Task* >( x ) )(); } )
+            , relocate_task( nullptr )
+            , destroy_task( nullptr )
+            , task( nullptr )
+            , buffer()
+            , priority( 0U )
+            , queued()
+            , deadline( std::chrono::steady_clock::time_point::max() )
+        {
+            emplace< Task >( std::integral_constant< bool, is_inline< Task >() >{},
+                             alloc,
+                             std::forward< Args >( args )... );
+        }
+        ~task_proxy() { reset(); }
+        task_proxy( task_proxy const& ) = delete;
+        task_proxy& operator=( task_proxy const& ) = delete;
+        task_proxy( task_proxy&& other ) noexcept
+            : check_task( other.check_task )
+            , execute_task( other.execute_task )
+            , relocate_task( other.relocate_task )
+            , destroy_task( other.destroy_task )
+            , task( nullptr )
+            , buffer()
+            , priority( other.priority )
+            , queued( other.queued )
+            , stop( std::move( other.stop ) )
+            , deadline( other.deadline )
+        {
+            take( other );
+        }
+        task_proxy& operator=( task_proxy&& other ) noexcept
+        {
+            if ( this != &other )
+            {
+                reset();
+                check_task    = other.check_task;
+                execute_task  = other.execute_task;
+                relocate_task = other.relocate_task;
+                destroy_task  = other.destroy_task;
+                priority      = other.priority;
+                queued        = other.queued;
+                stop          = std::move( other.stop );
+                deadline      = other.deadline;
+                take( other );
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Returns a pointer to the task
+         */
+        void* get() const noexcept { return task; }
+
+        /**
+         * @brief Returns true if the arguments of the task are ready or the task was cancelled,
+         * cancelled tasks run only to complete their future with be::task_cancelled
+         */
+        bool is_ready() const
+        {
+            return stop.stop_requested() || missed_deadline() || check_task( task );
+        }
+
+        bool has_deadline() const noexcept
+        {
+            return deadline != std::chrono::steady_clock::time_point::max();
+        }
+
+        /**
+         * @brief Returns true if the task has a deadline that passed, reads the clock only then
+         */
+        bool missed_deadline() const noexcept
+        {
+            return has_deadline() && std::chrono::steady_clock::now() > deadline;
+        }
+
+    private:
+        template< typename Task, typename TaskAllocator, typename... Args >
+        void emplace( std::true_type /*inline*/, TaskAllocator& alloc, Args&&... args )
+        {
+            Task* typed_task = reinterpret_cast< Task* >( &buffer ); // NOLINT
+            std::allocator_traits< TaskAllocator >::construct(
+                alloc, typed_task, alloc, std::forward< Args >( args )... );
+            task          = typed_task;
+            relocate_task = []( void* from, void* to ) {
+                Task* tsk = static_cast< Task* >( from );
+                ::new ( to ) Task( std::move( *tsk ) );
+                tsk->~Task();
+            };
+            destroy_task = []( void* x ) { static_cast< Task* >( x )->~Task(); };
+        }
+
+        template< typename Task, typename TaskAllocator, typename... Args >
+        void emplace( std::false_type /*inline*/, TaskAllocator& alloc, Args&&... args )
+        {
+            using traits     = std::allocator_traits< TaskAllocator >;
+            Task* typed_task = traits::allocate( alloc, 1 );
+            try
+            {
+                traits::construct( alloc, typed_task, alloc, std::forward< Args >( args )... );
+            }
+            catch ( ... )
+            {
+                traits::deallocate( alloc, typed_task, 1 );
+                throw;
+            }
+            task         = typed_task;
+            destroy_task = []( void* x ) {
+                Task* tsk = static_cast< Task* >( x );
+                auto  a   = tsk->alloc;
+                std::allocator_traits< decltype( a ) >::destroy( a, tsk );
+                std::allocator_traits< decltype( a ) >::deallocate( a, tsk, 1 );
+            };
+        }
+
+        void take( task_proxy& other ) noexcept
+        {
+            if ( other.task != nullptr && relocate_task != nullptr )
+            {
+                relocate_task( other.task, &buffer );
+                task = &buffer;
+            }
+            else
+            {
+                task = other.task;
+            }
+            other.task          = nullptr;
+            other.execute_task  = nullptr;
+            other.check_task    = nullptr;
+            other.relocate_task = nullptr;
+            other.destroy_task  = nullptr;
+        }
+
+        void reset() noexcept
+        {
+            if ( task != nullptr )
+            {
+                destroy_task( task );
+                task = nullptr;
+            }
+        }
+    };
+
+    /**
+     * @brief Creates a task from some callable as a new type with allocator
+     * support
+     */
+    template< typename Func >
+    auto make_task( Func&& task )
+    {
+        return make_task( allocator_, std::forward< Func >( task ) );
+    }
+
+    template< typename Func,
+              typename FuncType = std::remove_reference_t< std::remove_cv_t< Func > > >
+    static auto make_task( Allocator const& allocator, Func&& task )
+    {
+        struct TASKPOOL_HIDDEN Task : FuncType
+        {
+            using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
+            Task( TaskAllocator const& a, Func&& f )
+                : FuncType( std::forward< Func >( f ) )
+                , alloc( a )
+            {
             }
+            using FuncType::operator();
+            static bool     is_ready() { return true; }
+            TaskAllocator   alloc;
             ~Task()             = default;
             Task( Task const& ) = delete;
             Task& operator=( Task const& ) = delete;
-            Task( Task&& ) noexcept        = delete;
+            Task( Task&& )                 = default;
             Task& operator=( Task&& ) = delete;
         };
-        auto                         future = promise.get_future();
-        typename Task::TaskAllocator task_allocator( allocator_ );
-        Task*                        typed_task =
-            std::allocator_traits< typename Task::TaskAllocator >::allocate( task_allocator, 1 );
-        std::allocator_traits< typename Task::TaskAllocator >::construct( task_allocator,
-                                                                          typed_task,
-                                                                          task_allocator,
-                                                                          std::move( promise ),
-                                                                          task,
-                                                                          std::move( args_tuple ) );
-        ( *runtime_ ).push_task( launch, task_proxy( typed_task ) );
-        return future;
-    }
 
-    task_pool_t( std::chrono::nanoseconds const check_task_latency, unsigned const requested_count )
-        : runtime_( std::make_unique< pool_runtime >( check_task_latency, requested_count ) )
-        , allocator_()
-    {
+        return task_proxy( typename task_proxy::template task_type< Task >{},
+                           typename Task::TaskAllocator( allocator ),
+                           std::forward< Func >( task ) );
     }
 
-    task_pool_t( std::chrono::nanoseconds const check_task_latency,
-                 unsigned const                 requested_count,
-                 Allocator const&               alloc )
-        : runtime_( std::make_unique< pool_runtime >( check_task_latency, requested_count ) )
-        , allocator_( alloc )
-    {
-    }
+    template< class Promise,
+              typename Func,
+              typename ArgsTuple,
+              typename Future = promise_api::get_future_t< Promise >,
+              typename Return = future_api::get_result_t< Future >,
+              std::enable_if_t<
+                  std::is_class< std::remove_reference_t< std::remove_cv_t< Func > > >::value,
+                  bool > = true >
 
-    struct pool_runtime
+    Future
+    make_defered_task( task_options options, Promise promise, Func&& task, ArgsTuple args_tuple )
     {
-        std::condition_variable          task_added_     = {};
-        std::condition_variable          task_completed_ = {};
-        mutable std::mutex               tasks_mutex_    = {};
-        std::atomic< std::size_t >       tasks_queued_{ 0 };
-        std::atomic< std::size_t >       tasks_waiting_{ 0 };
-        std::atomic< std::size_t >       tasks_running_{ 0 };
-        std::queue< task_proxy >         tasks_;
-        mutable std::mutex               deferred_mutex_ = {};
-        std::queue< task_proxy >         deferred_;
-        std::atomic< std::size_t >       deferred_queued_{ 0 };
-        mutable std::mutex               check_tasks_mutex_ = {};
-        std::vector< task_proxy >        tasks_to_check_    = {};
-        std::atomic< bool >              waiting_{ false };
-        std::atomic< bool >              paused_{ false };
-        std::atomic< bool >              abort_{ false };
-        unsigned                         thread_count_ = 0;
-        std::unique_ptr< std::thread[] > threads_; //  NOLINT (c-arrays)
-        std::chrono::nanoseconds         task_check_latency_ = std::chrono::microseconds( 1 );
+        using FuncType = std::remove_reference_t< std::remove_cv_t< Func > >;
+        struct TASKPOOL_HIDDEN Task : FuncType
+        {
+            using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
+
+            TaskAllocator       alloc;
+            Promise             promise_;
+            ArgsTuple           arguments_;
+            mutable std::size_t ready_ = 0; // leading arguments known to be ready
+            Task( TaskAllocator const& a, Promise&& p, Func&& f, ArgsTuple&& arg )
+                : FuncType( std::forward< Func >( f ) )
+                , alloc( a )
+                , promise_( std::move( p ) )
+                , arguments_( std::move( arg ) )
+            {
+            }
+
+            bool is_ready() const
+            {
+                return check_argument_status(
+                    arguments_,
+                    ready_,
+                    std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            static constexpr bool is_event_driven()
+            {
+                return arguments_notify< ArgsTuple >(
+                    std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            void subscribe( continuation const& next )
+            {
+                subscribe_arguments(
+                    arguments_, next, std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            auto operator()()
+            {
+                try
+                {
+                    pool_runtime::throw_if_cancelled();
+                    invoke_deferred_task(
+                        promise_,
+                        std::mem_fn( &FuncType::operator() ),
+                        this,
+                        arguments_,
+                        std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+                }
+                catch ( ... )
+                {
+                    promise_.set_exception( std::current_exception() );
+                }
+            }
+            ~Task()             = default;
+            Task( Task const& ) = delete;
+            Task& operator=( Task const& ) = delete;
+            Task( Task&& )                 = default;
+            Task& operator=( Task&& ) = delete;
+        };
+        auto                         future = promise.get_future();
+        push_lazy_task< Task >( options,
+                                task_proxy( typename task_proxy::template task_type< Task >{},
+                                            typename Task::TaskAllocator( allocator_ ),
+                                            std::move( promise ),
+                                            std::forward< Func >( task ),
+                                            std::move( args_tuple ) ) );
+        return future;
+    }
+
+    template< class Promise,
+              typename Func,
+              typename ArgsTuple,
+              typename Future = promise_api::get_future_t< Promise >,
+              typename Return = future_api::get_result_t< Future >,
+              std::enable_if_t< be::is_function_pointer_v< Func >, bool > = true >
+    Future
+    make_defered_task( task_options options, Promise promise, Func&& task, ArgsTuple args_tuple )
+    {
+        struct TASKPOOL_HIDDEN Task
+        {
+            using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
+
+            TaskAllocator       alloc;
+            Func                func_;
+            Promise             promise_;
+            ArgsTuple           arguments_;
+            mutable std::size_t ready_ = 0; // leading arguments known to be ready
+            Task( TaskAllocator const& a, Promise&& p, Func&& f, ArgsTuple&& arg )
+                : alloc( a )
+                , func_( f )
+                , promise_( std::move( p ) )
+                , arguments_( std::move( arg ) )
+            {
+            }
+
+            bool is_ready() const
+            {
+                return check_argument_status(
+                    arguments_,
+                    ready_,
+                    std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            static constexpr bool is_event_driven()
+            {
+                return arguments_notify< ArgsTuple >(
+                    std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            void subscribe( continuation const& next )
+            {
+                subscribe_arguments(
+                    arguments_, next, std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            auto operator()()
+            {
+                try
+                {
+                    pool_runtime::throw_if_cancelled();
+                    invoke_deferred_task(
+                        promise_,
+                        func_,
+                        arguments_,
+                        std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+                }
+                catch ( ... )
+                {
+                    promise_.set_exception( std::current_exception() );
+                }
+            }
+            ~Task()             = default;
+            Task( Task const& ) = delete;
+            Task& operator=( Task const& ) = delete;
+            Task( Task&& )                 = default;
+            Task& operator=( Task&& ) = delete;
+        };
+        auto                         future = promise.get_future();
+        push_lazy_task< Task >( options,
+                                task_proxy( typename task_proxy::template task_type< Task >{},
+                                            typename Task::TaskAllocator( allocator_ ),
+                                            std::move( promise ),
+                                            std::forward< Func >( task ),
+                                            std::move( args_tuple ) ) );
+        return future;
+    }
+
+    template< class Promise,
+              typename Func,
+              typename ArgsTuple,
+              typename Future = promise_api::get_future_t< Promise >,
+              typename Return = future_api::get_result_t< Future >,
+              std::enable_if_t< std::is_member_function_pointer< Func >::value, bool > = true >
+
+    Future
+    make_defered_task( task_options options, Promise promise, Func task, ArgsTuple args_tuple )
+    {
+        struct TASKPOOL_HIDDEN Task
+        {
+            using TaskAllocator = decltype( rebind_alloc< Task >( std::declval< Allocator >() ) );
+
+            TaskAllocator       alloc;
+            Func                func_;
+            Promise             promise_;
+            ArgsTuple           arguments_;
+            mutable std::size_t ready_ = 0; // leading arguments known to be ready
+            Task( TaskAllocator const& a, Promise&& p, Func f, ArgsTuple&& arg )
+                : alloc( a )
+                , func_( f )
+                , promise_( std::move( p ) )
+                , arguments_( std::move( arg ) )
+            {
+            }
+
+            bool is_ready() const
+            {
+                return check_argument_status(
+                    arguments_,
+                    ready_,
+                    std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            static constexpr bool is_event_driven()
+            {
+                return arguments_notify< ArgsTuple >(
+                    std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            void subscribe( continuation const& next )
+            {
+                subscribe_arguments(
+                    arguments_, next, std::make_index_sequence< std::tuple_size< ArgsTuple >{} >{} );
+            }
+            auto operator()()
+            {
+                try
+                {
+                    pool_runtime::throw_if_cancelled();
+                    auto self = std::get< 0 >( arguments_ )();
+                    auto args = tail( arguments_ );
+                    invoke_deferred_task(
+                        promise_,
+                        std::mem_fn( func_ ),
+                        self,
+                        args,
+                        std::make_index_sequence< std::tuple_size< decltype( args ) >{} >{} );
+                }
+                catch ( ... )
+                {
+                    promise_.set_exception( std::current_exception() );
+                }
+            }
+            ~Task()             = default;
+            Task( Task const& ) = delete;
+            Task& operator=( Task const& ) = delete;
+            Task( Task&& )                 = default;
+            Task& operator=( Task&& ) = delete;
+        };
+        auto                         future = promise.get_future();
+        push_lazy_task< Task >( options,
+                                task_proxy( typename task_proxy::template task_type< Task >{},
+                                            typename Task::TaskAllocator( allocator_ ),
+                                            std::move( promise ),
+                                            task,
+                                            std::move( args_tuple ) ) );
+        return future;
+    }
+
+    /**
+     * @brief Hands a task with lazy arguments to the runtime
+     *
+     * @details If every argument can notify when it is ready the task is parked and queued by the
+     * continuation of its last argument, otherwise the task is polled by the task_checker.
+     */
+    template< typename Task >
+    void push_lazy_task( task_options options, task_proxy&& proxy )
+    {
+        if ( options.launch == std::launch::async && Task::is_event_driven() )
+        {
+            proxy.priority = ( *runtime_ ).level_of( options.priority );
+            proxy.stop     = std::move( options.stop );
+            proxy.deadline = options.deadline;
+            ( *runtime_ ).park_task( std::move( proxy ),
+                                     std::tuple_size< decltype( Task::arguments_ ) >::value,
+                                     []( void* x, continuation const& next ) {
+                                         static_cast< Task* >( x )->subscribe( next );
+                                     } );
+        }
+        else
+        {
+            ( *runtime_ ).push_task( options, std::move( proxy ) );
+        }
+    }
+
+    task_pool_t( std::chrono::nanoseconds const check_task_latency, unsigned const requested_count )
+        : task_pool_t( pool_options{ requested_count, check_task_latency } )
+    {
+    }
+
+    task_pool_t( std::chrono::nanoseconds const check_task_latency,
+                 unsigned const                 requested_count,
+                 Allocator const&               alloc )
+        : task_pool_t( pool_options{ requested_count, check_task_latency }, alloc )
+    {
+    }
+
+    /**
+     * @brief Returns the options of the current runtime with the given thread count
+     */
+    pool_options get_options( unsigned const thread_count ) const noexcept
+    {
+        pool_options options;
+        options.thread_count     = thread_count;
+        options.check_latency    = get_check_latency();
+        options.check_batch      = ( *runtime_ ).check_batch_;
+        options.scheduling       = get_schedule_policy();
+        options.idle             = get_idle_policy();
+        options.priority_levels  = get_priority_levels();
+        options.priority_aging   = ( *runtime_ ).priority_aging_;
+        options.numa             = get_numa_policy();
+        options.topology         = ( *runtime_ ).topology_;
+        options.threads          = ( *runtime_ ).thread_options_;
+        options.max_thread_count = ( *runtime_ ).elastic_ ? get_thread_capacity() : 0U;
+        options.grow_queue_wait  = ( *runtime_ ).grow_queue_wait_;
+        options.grow_queue_depth = ( *runtime_ ).grow_queue_depth_;
+        options.keep_alive       = ( *runtime_ ).keep_alive_;
+        options.queue_capacity   = get_queue_capacity();
+        options.overflow         = get_overflow_policy();
+        options.timer_resolution = get_timer_resolution();
+        return options;
+    }
+
+    struct pool_runtime
+    {
+        /**
+         * @brief Deque owned by a single thread when work stealing
+         *
+         * @details The owning thread pushes and pops at the back while other threads steal from
+         * the front. task_proxy owns its storage so slots can not be published through plain
+         * atomic loads as a lock free Chase-Lev deque would, instead each deque has a mutex of
+         * its own that is only ever contended while another thread is stealing from it.
+         */
+        struct worker_queue
+        {
+            std::mutex                 mutex_ = {};
+            std::deque< task_proxy >   tasks_ = {};
+            detail::cache_line_padding padding_{}; // keeps neighbouring deques apart
+        };
+
+        /**
+         * @brief One part of the tasks polled for their lazy arguments, see check_waiting_tasks
+         *
+         * @details Each submitting thread deals its tasks round-robin over the shards, starting at
+         * its own index, so submitters rarely contend on a mutex and every shard may be checked by
+         * a different thread at the same time.
+         */
+        struct check_shard
+        {
+            std::mutex                 mutex_  = {};
+            std::vector< task_proxy >  tasks_  = {}; // in the order they started waiting
+            std::size_t                cursor_ = 0;  // next of tasks_ to check
+            std::atomic< std::size_t > waiting_{ 0 }; // size of tasks_, read without the mutex
+            detail::cache_line_padding padding_{};
+        };
+
+        /**
+         * @brief Task waiting for its arguments to notify that they are ready
+         *
+         * @details `pending_` starts at the number of arguments plus one that is released once
+         * every argument has been subscribed to so the task can not be queued while it is still
+         * subscribing. The continuation of each argument decrements the count and the one reaching
+         * zero moves the task into the ready queue.
+         */
+        struct parked_task
+        {
+            parked_task( pool_runtime& runtime, task_proxy&& proxy, std::size_t pending )
+                : runtime_( runtime )
+                , proxy_( std::move( proxy ) )
+                , pending_( pending )
+            {
+            }
+            pool_runtime&                               runtime_;
+            task_proxy                                  proxy_;
+            std::atomic< std::size_t >                  pending_;
+            typename std::list< parked_task >::iterator position_;
+
+            static void argument_ready( void* x )
+            {
+                auto* parked = static_cast< parked_task* >( x );
+                if ( --( parked->pending_ ) == 0U )
+                {
+                    parked->runtime_.unpark_task( *parked );
+                }
+            }
+        };
+
+        /**
+         * @brief Identifies the pool and thread index of the calling thread
+         */
+        struct worker_context
+        {
+            pool_runtime const* runtime  = nullptr;
+            unsigned            index    = 0;
+            std::uint32_t       random   = 0;
+            bool                trying   = false; // in try_submit
+            bool                rejected = false; // the task of try_submit did not fit
+            pool_runtime const* running    = nullptr; // pool of the tasks run by this thread
+            unsigned            depth      = 0;       // tasks of running on the stack
+            unsigned            waited     = 0;       // of depth counted in waiting_depth_
+            bool                cancelling = false;   // the running task was cancelled
+            bool                expired    = false;   // the running task missed its deadline
+            unsigned            polled     = 0;       // lazy tasks dealt to the check shards
+        };
+
+        /**
+         * @brief Statistics of one thread, written by that thread only
+         *
+         * @details The padding keeps the counters of neighbouring threads on separate cache lines
+         * without relying on over-aligned allocation which C++14 does not provide.
+         */
+        struct worker_counters
+        {
+            detail::cache_line_padding   front_padding_{};
+            std::atomic< std::uint64_t > tasks_executed_{ 0 };
+            std::atomic< std::uint64_t > wakeups_{ 0 };
+            std::atomic< std::uint64_t > spurious_wakeups_{ 0 };
+            std::atomic< std::int64_t >  busy_ns_{ 0 };
+            std::atomic< std::int64_t >  idle_ns_{ 0 };
+            std::atomic< std::int64_t >  checker_ns_{ 0 };
+            std::atomic< std::int64_t >  queue_wait_ns_{ 0 };
+            std::atomic< std::uint64_t > deadline_misses_{ 0 };
+            detail::cache_line_padding   back_padding_{};
+
+#if BE_TASK_STATS
+            // with a single writer a relaxed load and store avoids the locked add
+            template< typename T >
+            static void add( std::atomic< T >& counter, T const value ) noexcept
+            {
+                counter.store( counter.load( std::memory_order_relaxed ) + value,
+                               std::memory_order_relaxed );
+            }
+#else
+            template< typename T >
+            static void add( std::atomic< T >& /*counter*/, T const /*value*/ ) noexcept
+            {
+            }
+#endif
+
+            worker_stats snapshot() const noexcept
+            {
+                using std::chrono::nanoseconds;
+                constexpr auto relaxed = std::memory_order_relaxed;
+                worker_stats   stats;
+                stats.tasks_executed   = tasks_executed_.load( relaxed );
+                stats.wakeups          = wakeups_.load( relaxed );
+                stats.spurious_wakeups = spurious_wakeups_.load( relaxed );
+                stats.busy_time        = nanoseconds( busy_ns_.load( relaxed ) );
+                stats.idle_time        = nanoseconds( idle_ns_.load( relaxed ) );
+                stats.checker_time     = nanoseconds( checker_ns_.load( relaxed ) );
+                stats.queue_wait_time  = nanoseconds( queue_wait_ns_.load( relaxed ) );
+                stats.deadline_misses  = deadline_misses_.load( relaxed );
+                return stats;
+            }
+        };
+
+        using ready_queue     = typename ReadyQueue::template queue_type< task_proxy >;
+        using priority_queues = std::deque< ready_queue >;
+        using priority_counts = std::vector< detail::padded_counter >;
+        using worker_threads  = std::unique_ptr< detail::worker_thread[] >; //  NOLINT (c-arrays)
+
+        // sleepers and waiters test the counters under tasks_mutex_, the ready queues
+        // synchronize on their own
+        std::condition_variable    task_added_     = {};
+        std::condition_variable    task_completed_ = {};
+        std::condition_variable    room_available_ = {}; // for submitters blocked on a full pool
+        mutable std::mutex         tasks_mutex_    = {};
+        priority_queues            tasks_; // one ready queue per priority level
+        priority_counts            tasks_queued_by_priority_; // tasks in tasks_
+        priority_counts            starved_since_; // dispatched_ when a level last got a turn
+        detail::cache_line_padding shared_padding_{};
+        std::atomic< std::size_t > dispatched_{ 0 }; // tasks taken while another level waited
+        detail::cache_line_padding dispatched_padding_{};
+
+        // set up on construction and read by every thread
+        unsigned                         priority_aging_  = 0;
+        unsigned                         thread_capacity_ = 0; // size of the per thread members
+        bool                             elastic_         = false;
+        std::chrono::nanoseconds         grow_queue_wait_{ 0 };
+        std::size_t                      grow_queue_depth_ = 0;
+        std::chrono::nanoseconds         keep_alive_{ 0 };
+        std::size_t                      queue_capacity_ = 0;
+        overflow_policy                  overflow_       = overflow_policy::block;
+        std::chrono::nanoseconds         task_check_latency_ = std::chrono::microseconds( 1 );
+        std::size_t                      check_batch_        = 0;
+        schedule_policy                  scheduling_         = schedule_policy::shared_queue;
+        idle_policy                      idle_               = idle_policy::latency;
+        std::vector< worker_queue >      worker_queues_;
+        std::vector< worker_counters >   worker_counters_;
+        worker_counters                  helper_counters_; // of threads outside the pool
+        thread_options                   thread_options_;
+        numa_policy                      numa_ = numa_policy::none;
+        numa_topology                    topology_;
+        std::vector< worker_queue >      node_queues_;   // one for each node group
+        std::vector< unsigned >          worker_nodes_;  // node group of each thread
+        std::vector< unsigned >          cpu_nodes_;     // node group of each processor
+        detail::sharded_counter          tasks_shared_;  // tasks in tasks_ and about to be pushed
+        detail::sharded_counter          tasks_local_;   // tasks in each of the worker_queues_
+        detail::sharded_counter          tasks_node_;    // tasks in each of the node_queues_
+        detail::sharded_counter          tasks_running_; // by thread, the last slot for others
+        detail::cache_line_padding       config_padding_{};
+
+        // flags are read in every loop of the threads and rarely written
+        std::atomic< unsigned >    waiting_{ 0 };       // threads in wait()
+        std::atomic< std::size_t > waiting_depth_{ 0 }; // tasks on the stacks of those threads
+        detail::cache_line_padding waiting_padding_{};
+        std::atomic< bool >        paused_{ false };
+        detail::cache_line_padding paused_padding_{};
+        std::atomic< bool >        abort_{ false };
+        stop_source                abort_source_; // fired along with abort_, see get_stop_token()
+        detail::cache_line_padding abort_padding_{};
+        std::atomic< unsigned >    sleeping_{ 0 };
+        detail::cache_line_padding sleeping_padding_{};
+        std::atomic< unsigned >    blocked_{ 0 }; // submitters waiting for room_available_
+        detail::cache_line_padding blocked_padding_{};
+        std::atomic< unsigned >    thread_count_{ 0 };
+        std::atomic< unsigned >    min_threads_{ 0 }; // kept while idle
+        std::atomic< unsigned >    max_threads_{ 0 }; // started on load
+        detail::cache_line_padding thread_count_padding_{};
+
+        // starting and stopping threads
+        mutable std::mutex         scale_mutex_ = {};
+        std::condition_variable    scale_changed_;
+        worker_threads             threads_;
+        std::vector< char >        running_; // threads_ that have not exited their loop
+        detail::worker_thread      monitor_; // checks the load of elastic pools
+
+        // tasks that are deferred or wait for their arguments
+        std::atomic< std::size_t > tasks_waiting_{ 0 };
+        std::atomic< std::size_t > tasks_polled_{ 0 };
+        std::atomic< bool >        poll_watch_{ false }; // a thread sleeps for the check latency
+        mutable std::mutex         deferred_mutex_ = {};
+        std::queue< task_proxy >   deferred_;
+        std::atomic< std::size_t > deferred_queued_{ 0 };
+        std::vector< check_shard > check_shards_; // one for each thread
+        mutable std::mutex         parked_mutex_      = {};
+        std::list< parked_task >   parked_            = {};
+        bool                       parking_closed_    = false;
+
+        /**
+         * @brief A timer waiting in timers_ for its expiry
+         */
+        struct timer
+        {
+            task_proxy                            task;   // of a timer expiring once
+            std::function< task_proxy() >         repeat; // makes the task of each periodic expiry
+            std::chrono::steady_clock::time_point due;
+            std::chrono::nanoseconds              period{ 0 };
+            unsigned                              priority = 0;
+            stop_token                            stop;    // of the timer_handle and the pool
+            std::shared_ptr< void >               forward; // forwards the options token to stop
+        };
+
+        // timers of submit_after, submit_at and submit_every, expired by one thread at a time
+        mutable std::mutex                    timers_mutex_ = {};
+        detail::timer_wheel< timer >          timers_;
+        std::chrono::steady_clock::time_point timer_origin_ = std::chrono::steady_clock::now();
+        std::chrono::nanoseconds              timer_resolution_{ 1 };
+        std::atomic< std::size_t >            timers_pending_{ 0 };
+        std::atomic< std::uint64_t >          next_timer_tick_{ detail::timer_wheel< timer >::never };
+        std::atomic< bool >                   timer_watch_{ false }; // a thread sleeps until then
+
+        explicit pool_runtime( pool_options const& options )
+            : tasks_( std::max( options.priority_levels, 1U ) )
+            , tasks_queued_by_priority_( tasks_.size() )
+            , starved_since_( tasks_.size() )
+            , priority_aging_( options.priority_aging )
+            , thread_capacity_( std::max( compute_thread_count( options.thread_count ),
+                                          options.max_thread_count ) )
+            , elastic_( thread_capacity_ > compute_thread_count( options.thread_count ) )
+            , grow_queue_wait_( options.grow_queue_wait )
+            , grow_queue_depth_( options.grow_queue_depth )
+            , keep_alive_( options.keep_alive )
+            , queue_capacity_( options.queue_capacity )
+            , overflow_( options.overflow )
+            , task_check_latency_( options.check_latency )
+            , check_batch_( std::max< std::size_t >( options.check_batch, 1U ) )
+            , scheduling_( options.scheduling )
+            , idle_( options.idle )
+            , worker_queues_( is_work_stealing() ? thread_capacity_ : 0U )
+            , worker_counters_( thread_capacity_ )
+            , thread_options_( options.threads )
+            , numa_( options.numa )
+            , topology_( numa_topology_of( options ) )
+            , node_queues_( std::min< std::size_t >( topology_.size(), thread_capacity_ ) )
+            , worker_nodes_( node_queues_.empty() ? 0U : thread_capacity_ )
+            , tasks_shared_( thread_capacity_ + 1U )
+            , tasks_local_( worker_queues_.size() )
+            , tasks_node_( node_queues_.size() )
+            , tasks_running_( thread_capacity_ + 1U )
+            , min_threads_( compute_thread_count( options.thread_count ) )
+            , max_threads_( thread_capacity_ )
+            , running_( thread_capacity_, 0 )
+            , check_shards_( thread_capacity_ )
+            , timer_resolution_( std::max( options.timer_resolution, std::chrono::nanoseconds( 1 ) ) )
+        {
+            group_by_node();
+            create_threads();
+        }
+        ~pool_runtime()
+        {
+            destroy_threads();
+            // parked tasks must release their subscriptions before any task that may notify them
+            // is destroyed with the queues
+            std::list< parked_task > parked;
+            {
+                std::unique_lock< std::mutex > lock( parked_mutex_ );
+                parking_closed_ = true;
+                std::swap( parked, parked_ );
+            }
+        }
+        pool_runtime( pool_runtime const& ) = delete;
+        pool_runtime& operator=( pool_runtime const& ) = delete;
+        pool_runtime( pool_runtime&& )                 = delete;
+        pool_runtime& operator=( pool_runtime&& ) = delete;
+
+        void create_threads()
+        {
+            abort_   = false;
+            threads_ = std::make_unique< detail::worker_thread[] >( thread_capacity_ ); // NOLINT
+            {
+                std::unique_lock< std::mutex > lock( scale_mutex_ );
+                start_threads( min_threads_ );
+            }
+            if ( elastic_ )
+            {
+                monitor_ = detail::worker_thread( 0U, [this] { monitor_load(); } );
+            }
+        }
+
+        void destroy_threads()
+        {
+            {
+                std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+                abort_ = true;
+                task_added_.notify_all();
+                room_available_.notify_all();
+            }
+            // callbacks of the tokens run here, outside of the locks of the pool
+            abort_source_.request_stop();
+            {
+                // no thread is started once this lock was taken after setting abort_
+                std::unique_lock< std::mutex > lock( scale_mutex_ );
+                scale_changed_.notify_all();
+            }
+            if ( monitor_.joinable() )
+            {
+                monitor_.join();
+            }
+            for ( unsigned i = 0; threads_ && i < thread_capacity_; ++i )
+            {
+                if ( threads_[i].joinable() )
+                {
+                    threads_[i].join();
+                }
+            }
+            threads_.reset(); //  NOLINT (c-arrays)
+            thread_count_ = 0;
+        }
+
+        /**
+         * @brief Starts threads in unused slots until there are count threads, must run with
+         * scale_mutex_ held
+         *
+         * @details Slots of threads that have exited are reused after joining them. Failing to
+         * start a thread stops adding threads unless there are none at all.
+         */
+        void start_threads( unsigned const count )
+        {
+            for ( unsigned i = 0; i < thread_capacity_ && thread_count_ < count && !abort_; ++i )
+            {
+                if ( running_[i] != 0 )
+                {
+                    continue;
+                }
+                if ( threads_[i].joinable() )
+                {
+                    threads_[i].join();
+                }
+                try
+                {
+                    threads_[i] = detail::worker_thread(
+                        thread_options_.stack_size,
+                        [this, i, latency = task_check_latency_] { run_worker( i, latency ); } );
+                }
+                catch ( std::system_error const& )
+                {
+                    if ( thread_count_ == 0U )
+                    {
+                        throw;
+                    }
+                    return;
+                }
+                running_[i] = 1;
+                ++thread_count_;
+            }
+        }
+
+        /**
+         * @brief Lets the thread with the given index exit unless that would leave fewer than
+         * min_threads_, the thread must not have tasks in its deque
+         */
+        bool retire_thread( unsigned const index )
+        {
+            std::unique_lock< std::mutex > lock( scale_mutex_ );
+            if ( thread_count_ <= min_threads_ )
+            {
+                return false;
+            }
+            running_[index] = 0;
+            --thread_count_;
+            return true;
+        }
+
+        /**
+         * @brief Returns true if there are more threads than allowed, surplus threads exit
+         * without waiting for the keep alive to pass
+         */
+        bool has_surplus_threads() const noexcept { return thread_count_ > max_threads_; }
+
+        void set_thread_count( unsigned count )
+        {
+            count = std::min( std::max( count, 1U ), thread_capacity_ );
+            {
+                std::unique_lock< std::mutex > lock( scale_mutex_ );
+                min_threads_ = count;
+                max_threads_ = elastic_ ? thread_capacity_ : count;
+                start_threads( count );
+            }
+            // sleeping surplus threads have to wake up to exit
+            std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+            task_added_.notify_all();
+        }
+
+        /**
+         * @brief Adds threads to elastic pools while tasks queue up and no thread is sleeping
+         *
+         * @details Runs on a thread of its own since the threads of the pool may all be blocked
+         * in their tasks.
+         */
+        void monitor_load()
+        {
+            std::unique_lock< std::mutex > lock( scale_mutex_ );
+            bool                           backlog = false;
+            while ( !abort_ )
+            {
+                scale_changed_.wait_for( lock, grow_queue_wait_ );
+                if ( abort_ )
+                {
+                    break;
+                }
+                std::size_t const queued = paused_ ? 0U : tasks_queued();
+                bool const        busy   = queued != 0U && sleeping_.load() == 0U;
+                if ( busy && ( backlog || queued > grow_queue_depth_ * thread_count_ ) )
+                {
+                    start_threads( std::min< unsigned >( thread_count_ + 1U, max_threads_ ) );
+                    backlog = false;
+                }
+                else
+                {
+                    backlog = busy;
+                }
+            }
+        }
+
+        void abort() { destroy_threads(); }
+
+        void unpause()
+        {
+            std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+            paused_ = false;
+            task_added_.notify_all();
+        }
+
+        /**
+         * @brief Returns the context of the calling thread, default constructed for threads that
+         * are not part of any pool
+         */
+        static worker_context& this_worker() noexcept
+        {
+            static thread_local worker_context context;
+            return context;
+        }
+
+        bool is_work_stealing() const noexcept
+        {
+            return scheduling_ == schedule_policy::work_stealing;
+        }
+
+        /**
+         * @brief Returns the nodes to group the threads by, a single node without known processors
+         * if the topology could not be read
+         */
+        static numa_topology numa_topology_of( pool_options const& options )
+        {
+            if ( options.numa != numa_policy::node_groups )
+            {
+                return {};
+            }
+            numa_topology topology =
+                options.topology.empty() ? read_numa_topology() : options.topology;
+            if ( topology.empty() )
+            {
+                topology.emplace_back();
+            }
+            return topology;
+        }
+
+        /**
+         * @brief Assigns threads to node groups in turn and maps processors to groups
+         *
+         * @details Interleaving keeps the groups balanced whatever number of threads is running
+         * since threads are started in the order of their index.
+         */
+        void group_by_node()
+        {
+            auto const groups = static_cast< unsigned >( node_queues_.size() );
+            for ( unsigned i = 0; i < worker_nodes_.size(); ++i )
+            {
+                worker_nodes_[i] = i % groups;
+            }
+            for ( unsigned node = 0; node < groups; ++node )
+            {
+                for ( unsigned const cpu : topology_[node].cpus )
+                {
+                    if ( cpu >= cpu_nodes_.size() )
+                    {
+                        cpu_nodes_.resize( cpu + 1U, groups );
+                    }
+                    if ( cpu_nodes_[cpu] == groups )
+                    {
+                        cpu_nodes_[cpu] = node;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the node group tasks submitted by the calling thread are queued in
+         */
+        unsigned node_of_caller() const noexcept
+        {
+            worker_context const& worker = this_worker();
+            if ( worker.runtime == this )
+            {
+                return worker_nodes_[worker.index];
+            }
+            int const cpu = detail::current_cpu();
+            if ( cpu >= 0 && static_cast< std::size_t >( cpu ) < cpu_nodes_.size() &&
+                 cpu_nodes_[static_cast< std::size_t >( cpu )] < node_queues_.size() )
+            {
+                return cpu_nodes_[static_cast< std::size_t >( cpu )];
+            }
+            return 0U;
+        }
+
+        static unsigned compute_thread_count( const unsigned thread_count ) noexcept
+        {
+            // we need at least two threads to process work and check futures
+            if ( thread_count > 0 )
+            {
+                return thread_count;
+            }
+            else
+            {
+                if ( std::thread::hardware_concurrency() > 0 )
+                {
+                    return std::thread::hardware_concurrency();
+                }
+                else
+                {
+                    return 1;
+                }
+            }
+        }
+
+        /**
+         * @brief Counts a thread in wait() and the tasks of the pool on its stack
+         *
+         * @details Threads of the pool stop waiting once the only tasks left are the ones on the
+         * stacks of waiting threads, leaving out just their own tasks two tasks waiting at the
+         * same time would wait for each other. A wait nested in a task run by an outer wait of
+         * the same thread adds only the tasks above the outer one. Threads outside the pool wait
+         * for every task.
+         */
+        struct waiting_scope
+        {
+            pool_runtime&   runtime;
+            worker_context& worker;
+            unsigned        previous; // worker.waited on entry
+            unsigned        own;      // tasks of the runtime on the stack of the calling thread
+
+            explicit waiting_scope( pool_runtime& waited ) noexcept
+                : runtime( waited )
+                , worker( this_worker() )
+                , previous( worker.waited )
+                , own( worker.running == &waited ? worker.depth : 0U )
+            {
+                ++runtime.waiting_;
+                if ( own > previous )
+                {
+                    runtime.waiting_depth_ += own - previous;
+                    worker.waited = own;
+                    // other waiters may be left with nothing but waiting tasks now
+                    runtime.notify_waiters();
+                }
+            }
+            ~waiting_scope()
+            {
+                runtime.waiting_depth_ -= worker.waited - previous;
+                worker.waited = previous;
+                --runtime.waiting_;
+            }
+            waiting_scope( waiting_scope const& ) = delete;
+            waiting_scope& operator=( waiting_scope const& ) = delete;
+
+            bool idle() const noexcept
+            {
+                if ( runtime.paused_ )
+                {
+                    return true;
+                }
+                std::size_t const total = runtime.tasks_total();
+                return own == 0U ? total == 0U : total <= runtime.waiting_depth_.load();
+            }
+        };
+
+        /**
+         * @brief Waits for every task but the ones of waiting threads, running queued tasks
+         * itself meanwhile
+         *
+         * @details The calling thread only sleeps while nothing is queued and wakes up whenever a
+         * task completed to look again, so tasks waiting for the tasks they submitted can not
+         * deadlock the pool.
+         */
+        void wait() noexcept
+        {
+            try
+            {
+                waiting_scope const scope( *this );
+                for ( ;; )
+                {
+                    if ( scope.idle() )
+                    {
+                        break;
+                    }
+                    if ( run_next_task( caller_slot() ) )
+                    {
+                        continue;
+                    }
+                    std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+                    task_added_.notify_all();
+                    task_completed_.wait( tasks_lock,
+                                          [&] { return scope.idle() || tasks_queued() != 0U; } );
+                }
+            }
+            catch ( std::system_error const& e ) // std::mutex::lock may throw
+            {
+                // TODO: implement user logging facility
+            }
+        }
+
+        std::future_status wait_for( std::chrono::steady_clock::duration duration ) noexcept
+        {
+            return wait_until( std::chrono::steady_clock::now() + duration );
+        }
+
+        /**
+         * @brief Waits like wait() until the deadline
+         *
+         * @details Only tasks of the pool run queued tasks meanwhile as they could otherwise
+         * deadlock, a task run that way may complete after the deadline. Other threads just sleep
+         * so they return in time even if the queued tasks wait on what they do next.
+         */
+        std::future_status wait_until( std::chrono::steady_clock::time_point deadline ) noexcept
+        {
+            try
+            {
+                waiting_scope const scope( *this );
+                for ( ;; )
+                {
+                    if ( scope.idle() )
+                    {
+                        break;
+                    }
+                    if ( std::chrono::steady_clock::now() >= deadline )
+                    {
+                        return std::future_status::timeout;
+                    }
+                    if ( scope.own != 0U && run_next_task( caller_slot() ) )
+                    {
+                        continue;
+                    }
+                    std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+                    task_added_.notify_all();
+                    task_completed_.wait_until( tasks_lock, deadline, [&] {
+                        return scope.idle() || ( scope.own != 0U && tasks_queued() != 0U );
+                    } );
+                }
+            }
+            catch ( std::system_error const& e ) // std::mutex::lock may throw
+            {
+                // TODO: implement user logging facility
+            }
+            return std::future_status::ready;
+        }
+
+        void push_task( task_options options, task_proxy proxy )
+        {
+            if ( proxy.get() == nullptr ) // NOLINT
+            {
+                throw std::invalid_argument{ "'add_task' called with invalid task_proxy" };
+            }
+            proxy.priority = level_of( options.priority );
+            proxy.stop     = std::move( options.stop );
+            proxy.deadline = options.deadline;
+            if ( is_full() )
+            {
+                switch ( admit_tasks( 1U, proxy.is_ready() ) )
+                {
+                case admission::reject:
+                    return;
+                case admission::run_inline:
+                    run_inline( std::move( proxy ) );
+                    return;
+                default:
+                    break;
+                }
+            }
+            queue_task( options.launch, std::move( proxy ) );
+        }
+
+        /**
+         * @brief Returns the first tick of the timers at or after the time
+         */
+        std::uint64_t tick_after( std::chrono::steady_clock::time_point const time ) const noexcept
+        {
+            auto const since =
+                std::chrono::duration_cast< std::chrono::nanoseconds >( time - timer_origin_ );
+            if ( since.count() <= 0 )
+            {
+                return 0U;
+            }
+            return static_cast< std::uint64_t >( ( since + timer_resolution_ -
+                                                   std::chrono::nanoseconds( 1 ) ) /
+                                                 timer_resolution_ );
+        }
+
+        std::uint64_t now_tick() const noexcept
+        {
+            return static_cast< std::uint64_t >( ( std::chrono::steady_clock::now() - timer_origin_ ) /
+                                                 timer_resolution_ );
+        }
+
+        std::chrono::steady_clock::time_point tick_time( std::uint64_t const tick ) const noexcept
+        {
+            return timer_origin_ + static_cast< std::chrono::nanoseconds::rep >( tick ) *
+                                       timer_resolution_;
+        }
+
+        /**
+         * @brief Whether the timer wheel has to be advanced, read in every loop of the threads
+         */
+        bool timers_due() const noexcept
+        {
+            std::uint64_t const next = next_timer_tick_.load();
+            return next != detail::timer_wheel< timer >::never && now_tick() >= next;
+        }
+
+        /**
+         * @brief Whether there are timers but no thread sleeping until the next one
+         */
+        bool needs_timer_watch() const noexcept
+        {
+            return next_timer_tick_.load() != detail::timer_wheel< timer >::never && !timer_watch_;
+        }
+
+        /**
+         * @brief Publishes the next tick of the wheel, returns true if it moved closer
+         */
+        bool update_next_timer() noexcept
+        {
+            std::uint64_t const next = timers_.next_tick();
+            return next < next_timer_tick_.exchange( next );
+        }
+
+        /**
+         * @brief Adds a timer, a timer that is already due expires with the next tick
+         *
+         * @details Only a timer that is now the next to expire wakes a thread, the one sleeping
+         * until the previous next timer if there is one.
+         */
+        void add_timer( std::chrono::steady_clock::time_point const due,
+                        std::chrono::nanoseconds const              period,
+                        timer                                       entry )
+        {
+            entry.due    = due;
+            entry.period = period;
+            bool earliest;
+            {
+                std::unique_lock< std::mutex > lock( timers_mutex_ );
+                timers_.add( std::max( tick_after( due ), timers_.current() + 1U ), entry );
+                ++timers_pending_;
+                earliest = update_next_timer();
+            }
+            if ( earliest )
+            {
+                std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+                if ( timer_watch_ )
+                {
+                    task_added_.notify_all();
+                }
+                else
+                {
+                    task_added_.notify_one();
+                }
+            }
+        }
+
+        /**
+         * @brief Advances the timer wheel returning the tasks of the timers that expired
+         *
+         * @details Periodic timers are added again for the first expiry after now, cancelled timers
+         * are dropped here rather than searched for when they are cancelled. Returns nothing if
+         * another thread is at it.
+         */
+        std::vector< task_proxy > expire_timers()
+        {
+            std::vector< task_proxy >      expired;
+            std::unique_lock< std::mutex > lock( timers_mutex_, std::try_to_lock );
+            if ( !lock.owns_lock() )
+            {
+                return expired;
+            }
+            std::vector< timer > due;
+            timers_.advance( now_tick(),
+                             [&due]( timer&& entry ) { due.push_back( std::move( entry ) ); } );
+            auto const now = std::chrono::steady_clock::now();
+            for ( timer& entry : due )
+            {
+                if ( entry.stop.stop_requested() )
+                {
+                    --timers_pending_;
+                    continue;
+                }
+                task_proxy proxy = entry.repeat ? entry.repeat() : std::move( entry.task );
+                proxy.priority   = entry.priority;
+                proxy.stop       = entry.stop;
+                expired.push_back( std::move( proxy ) );
+                if ( !entry.repeat )
+                {
+                    --timers_pending_;
+                    continue;
+                }
+                entry.due += entry.period;
+                if ( entry.due <= now )
+                {
+                    entry.due += ( ( now - entry.due ) / entry.period + 1 ) * entry.period;
+                }
+                timers_.add( std::max( tick_after( entry.due ), timers_.current() + 1U ), entry );
+            }
+            update_next_timer();
+            return expired;
+        }
+
+        /**
+         * @brief Queues a task according to its launch policy and the readiness of its arguments
+         */
+        void queue_task( std::launch const launch, task_proxy proxy )
+        {
+            if ( launch == std::launch::async )
+            {
+                if ( proxy.is_ready() )
+                {
+                    push_ready_task( std::move( proxy ) );
+                    return;
+                }
+                {
+                    check_shard&                   shard = next_shard();
+                    std::unique_lock< std::mutex > lock( shard.mutex_ );
+                    shard.tasks_.push_back( std::move( proxy ) );
+                    ++shard.waiting_;
+                    ++tasks_waiting_;
+                    ++tasks_polled_;
+                }
+                // sleepers decide under tasks_mutex_ whether to wake up to poll
+                std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+                task_added_.notify_one();
+            }
+            else
+            {
+                std::unique_lock< std::mutex > lock( deferred_mutex_ );
+                deferred_.push( std::move( proxy ) );
+                ++deferred_queued_;
+            }
+        }
+
+        enum class admission
+        {
+            queue,
+            reject,
+            run_inline,
+        };
+
+        /**
+         * @brief Returns the number of tasks that count toward the queue capacity
+         */
+        std::size_t tasks_pending() const noexcept
+        {
+            return tasks_queued() + tasks_waiting_.load() + deferred_queued_.load();
+        }
+
+        bool is_full() const noexcept
+        {
+            return queue_capacity_ != 0U && tasks_pending() >= queue_capacity_;
+        }
+
+        /**
+         * @brief Applies the overflow policy to count tasks submitted while the pool is full
+         *
+         * @param runnable - false if the tasks wait for their arguments and can not run right away
+         */
+        admission admit_tasks( std::size_t const count, bool const runnable )
+        {
+            worker_context& worker = this_worker();
+            if ( worker.trying )
+            {
+                worker.rejected = true;
+                return admission::reject;
+            }
+            switch ( overflow_ )
+            {
+            case overflow_policy::reject:
+                return admission::reject;
+            case overflow_policy::drop_oldest:
+                for ( std::size_t i = 0; i < count; ++i )
+                {
+                    if ( !drop_oldest_task() )
+                    {
+                        return admission::reject;
+                    }
+                }
+                return admission::queue;
+            case overflow_policy::caller_runs:
+                if ( runnable )
+                {
+                    return admission::run_inline;
+                }
+                break;
+            default:
+                break;
+            }
+            if ( worker.runtime == this )
+            {
+                // the threads of the pool may be the only ones able to make room
+                return runnable ? admission::run_inline : admission::queue;
+            }
+            std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+            for ( bool invoked = false;; )
+            {
+                ++blocked_;
+                room_available_.wait( tasks_lock, [this] {
+                    return abort_ || !is_full() || deferred_queued_.load() >= queue_capacity_;
+                } );
+                --blocked_;
+                if ( abort_ || !is_full() )
+                {
+                    return admission::queue;
+                }
+                if ( invoked )
+                {
+                    // the deferred tasks are still waiting for their arguments
+                    return admission::reject;
+                }
+                // no thread makes room for deferred tasks, run them instead of waiting forever
+                tasks_lock.unlock();
+                invoke_deferred();
+                invoked = true;
+                tasks_lock.lock();
+            }
+        }
+
+        /**
+         * @brief Discards the oldest task of the lowest priority shared queue holding tasks
+         */
+        bool drop_oldest_task()
+        {
+            for ( std::size_t level = tasks_.size(); level-- > 0U; )
+            {
+                task_proxy proxy;
+                if ( tasks_queued_by_priority_[level].value_.load() != 0U &&
+                     pop_shared_task( level, proxy ) )
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Runs a ready task on the calling thread instead of queueing it
+         */
+        void run_inline( task_proxy proxy )
+        {
+            unsigned const slot = caller_slot();
+            tasks_running_.add( slot, 1 );
+            running_scope const scope( *this, proxy );
+            proxy.execute_task( proxy.get() );
+            tasks_running_.add( slot, -1 );
+            notify_waiters();
+        }
+
+        /**
+         * @brief Returns the slot of tasks_running_ for tasks run by the calling thread, the last
+         * one for threads that are not part of the pool
+         */
+        unsigned caller_slot() const noexcept
+        {
+            worker_context const& worker = this_worker();
+            return worker.runtime == this ? worker.index : thread_capacity_;
+        }
+
+        /**
+         * @brief Counts a task of the pool on the stack of the calling thread while it runs
+         *
+         * @details wait() leaves these out of the tasks it waits for, a task waiting on its own
+         * pool would wait for itself otherwise. Tasks whose stop_token fired before they started
+         * run in cancelling mode, see throw_if_cancelled().
+         */
+        struct running_scope
+        {
+            worker_context&     worker;
+            pool_runtime const* previous;
+            unsigned            depth;
+            bool                cancelling;
+            bool                expired;
+
+            running_scope( pool_runtime const& runtime, task_proxy const& proxy ) noexcept
+                : worker( this_worker() )
+                , previous( worker.running )
+                , depth( worker.depth )
+                , cancelling( worker.cancelling )
+                , expired( worker.expired )
+            {
+                worker.depth      = previous == &runtime ? depth + 1U : 1U;
+                worker.running    = &runtime;
+                worker.cancelling = proxy.stop.stop_requested();
+                worker.expired    = proxy.missed_deadline();
+            }
+            ~running_scope()
+            {
+                worker.running    = previous;
+                worker.depth      = depth;
+                worker.cancelling = cancelling;
+                worker.expired    = expired;
+            }
+            running_scope( running_scope const& ) = delete;
+            running_scope& operator=( running_scope const& ) = delete;
+        };
+
+        /**
+         * @brief Called by tasks first thing inside the block storing exceptions in their promise,
+         * so a cancelled task completes with be::task_cancelled without calling its function
+         */
+        static void throw_if_cancelled()
+        {
+            if ( this_worker().expired )
+            {
+                throw deadline_exceeded{};
+            }
+            if ( is_cancelling() )
+            {
+                throw task_cancelled{};
+            }
+        }
+
+        static bool is_cancelling() noexcept
+        {
+            return this_worker().cancelling || this_worker().expired;
+        }
+
+        /**
+         * @brief Wakes a submitter blocked on a full pool after a task left the queues
+         *
+         * @details Works like notify_sleeper with `blocked_` in place of `sleeping_`.
+         */
+        void notify_submitters()
+        {
+            if ( blocked_.load() != 0U )
+            {
+                std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
+                room_available_.notify_one();
+            }
+        }
+
+        /**
+         * @brief Queues a task that is ready to run
+         */
+        void push_ready_task( task_proxy proxy )
+        {
+            proxy.queued                 = detail::stats_timer{};
+            worker_context const& worker = this_worker();
+            // tasks with a deadline go to the shared queues which may order them by it
+            if ( proxy.has_deadline() )
+            {
+                push_shared_task( std::move( proxy ) );
+                notify_sleeper();
+                return;
+            }
+            if ( is_work_stealing() && worker.runtime == this && proxy.priority == normal_level() )
+            {
+                push_queue_task(
+                    worker_queues_[worker.index], tasks_local_, worker.index, std::move( proxy ) );
+                return;
+            }
+            if ( !node_queues_.empty() && proxy.priority == normal_level() )
+            {
+                unsigned const node = node_of_caller();
+                push_queue_task( node_queues_[node], tasks_node_, node, std::move( proxy ) );
+                return;
+            }
+            push_shared_task( std::move( proxy ) );
+            notify_sleeper();
+        }
+
+        /**
+         * @brief Returns the priority level tasks of the given priority are queued at
+         */
+        unsigned level_of( task_priority const priority ) const noexcept
+        {
+            return std::min( static_cast< unsigned >( priority ),
+                             static_cast< unsigned >( tasks_.size() ) - 1U );
+        }
+
+        unsigned normal_level() const noexcept { return level_of( task_priority::normal ); }
+
+        /**
+         * @brief Returns the number of tasks in the shared queue and the deques of all threads
+         */
+        std::size_t tasks_queued() const noexcept
+        {
+            return tasks_shared_.load() + tasks_local_.load() + tasks_node_.load();
+        }
+
+        /**
+         * @brief Returns the number of tasks queued at the given priority level, the deques of
+         * threads and node groups only hold tasks of normal priority
+         */
+        std::size_t tasks_queued( unsigned const level ) const noexcept
+        {
+            std::size_t const owned =
+                level == normal_level() ? tasks_local_.load() + tasks_node_.load() : 0U;
+            return tasks_queued_by_priority_[level].value_.load() + owned;
+        }
+
+        /**
+         * @brief Returns the number of tasks queued, running and waiting for their arguments
+         *
+         * @details The queues are read before the running tasks which are counted before they
+         * leave a queue so a task moving from one to the other is never missed.
+         */
+        std::size_t tasks_total() const noexcept
+        {
+            return tasks_queued() + tasks_running_.load() + tasks_waiting_.load();
+        }
+
+        /**
+         * @brief Returns true if tasks of a higher than normal priority are queued
+         *
+         * @details Those are always in the shared queue so workers of a work stealing pool check
+         * this before running tasks of their own deque.
+         */
+        bool has_urgent_tasks() const noexcept
+        {
+            for ( unsigned level = 0; level < normal_level(); ++level )
+            {
+                if ( tasks_queued_by_priority_[level].value_.load() != 0U )
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Counts tasks about to be pushed onto the shared queue of the given level
+         *
+         * @details Tasks are counted before they are pushed so the counters never drop below
+         * zero, a thread finding a counted task missing from its queue simply tries again.
+         */
+        void count_shared_tasks( unsigned const level, std::size_t const count )
+        {
+            if ( tasks_queued_by_priority_[level].value_.fetch_add( count ) == 0U )
+            {
+                starved_since_[level].value_ = dispatched_.load();
+            }
+            tasks_shared_.add( caller_slot(), static_cast< std::ptrdiff_t >( count ) );
+        }
+
+        /**
+         * @brief Adds a task to the shared queue of its priority
+         */
+        void push_shared_task( task_proxy proxy )
+        {
+            unsigned const level = proxy.priority;
+            count_shared_tasks( level, 1U );
+            tasks_[level].push( std::move( proxy ) );
+        }
+
+        /**
+         * @brief Returns the priority level the next shared task is taken from
+         *
+         * @details Every priority_aging_ tasks dispatched while a level has tasks but does not
+         * get a turn raise its effective priority by one level so low priority tasks are not
+         * starved by a steady stream of high priority tasks. Ties go to the higher priority.
+         * Returns the number of levels if there are no shared tasks.
+         */
+        std::size_t next_shared_level() const noexcept
+        {
+            std::size_t const dispatched = dispatched_.load();
+            std::size_t       next       = tasks_.size();
+            std::ptrdiff_t    best       = 0;
+            for ( std::size_t level = 0; level < tasks_.size(); ++level )
+            {
+                if ( tasks_queued_by_priority_[level].value_.load() == 0U )
+                {
+                    continue;
+                }
+                auto effective = static_cast< std::ptrdiff_t >( level );
+                if ( priority_aging_ != 0U )
+                {
+                    std::size_t const since = starved_since_[level].value_.load();
+                    std::size_t const age   = dispatched > since ? dispatched - since : 0U;
+                    effective -= static_cast< std::ptrdiff_t >( age / priority_aging_ );
+                }
+                if ( next == tasks_.size() || effective < best )
+                {
+                    next = level;
+                    best = effective;
+                }
+            }
+            return next;
+        }
+
+        /**
+         * @brief Takes the next task off the shared queues, returns false if there is none
+         *
+         * @details Falls back to the other levels in order of priority if the chosen one turns
+         * out to be empty, which happens when other threads got there first.
+         */
+        bool pop_shared_task( task_proxy& proxy )
+        {
+            std::size_t const next = next_shared_level();
+            if ( next == tasks_.size() )
+            {
+                return false;
+            }
+            if ( pop_shared_task( next, proxy ) )
+            {
+                return true;
+            }
+            for ( std::size_t level = 0; level < tasks_.size(); ++level )
+            {
+                if ( level != next && tasks_queued_by_priority_[level].value_.load() != 0U &&
+                     pop_shared_task( level, proxy ) )
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool pop_shared_task( std::size_t const level, task_proxy& proxy )
+        {
+            if ( !tasks_[level].try_pop( proxy ) )
+            {
+                return false;
+            }
+            --tasks_queued_by_priority_[level].value_;
+            tasks_shared_.add( caller_slot(), -1 );
+            dispatched_from( level );
+            return true;
+        }
+
+        /**
+         * @brief Ages the levels that wait while a task is taken from the given one
+         *
+         * @details Only tasks taken while another level holds tasks count towards the age, so a
+         * pool using a single level at a time only reads the shared count instead of bumping it
+         * on every task.
+         */
+        void dispatched_from( std::size_t const level ) noexcept
+        {
+            if ( priority_aging_ == 0U )
+            {
+                return;
+            }
+            std::atomic< std::size_t >& since = starved_since_[level].value_;
+            for ( std::size_t other = 0; other < tasks_.size(); ++other )
+            {
+                if ( other != level && tasks_queued_by_priority_[other].value_.load() != 0U )
+                {
+                    since = ++dispatched_;
+                    return;
+                }
+            }
+            std::size_t const dispatched = dispatched_.load();
+            if ( since.load() != dispatched )
+            {
+                since = dispatched;
+            }
+        }
+
+        /**
+         * @brief Pops and runs a task of the shared queues
+         *
+         * @details The task is counted as running before it leaves the queue, see tasks_total.
+         */
+        bool run_shared_task( unsigned const index )
+        {
+            if ( tasks_shared_.load() == 0U || paused_ || abort_ )
+            {
+                return false;
+            }
+            tasks_running_.add( index, 1 );
+            task_proxy proxy;
+            if ( !pop_shared_task( proxy ) )
+            {
+                tasks_running_.add( index, -1 );
+                notify_waiters();
+                return false;
+            }
+            run_task( index, std::move( proxy ) );
+            return true;
+        }
+
+        /**
+         * @brief Returns how many of count tasks fit in the queue capacity
+         */
+        std::size_t room_for( std::size_t const count ) const noexcept
+        {
+            if ( queue_capacity_ == 0U )
+            {
+                return count;
+            }
+            std::size_t const pending = tasks_pending();
+            return pending < queue_capacity_ ? std::min( count, queue_capacity_ - pending ) : 0U;
+        }
+
+        /**
+         * @brief Queues a batch of ready tasks in chunks that fit the queue capacity
+         *
+         * @details Every task of the batch gets the priority, stop token and deadline of the
+         * options. Tasks that do not fit are subject to the overflow policy, a rejected task
+         * rejects the rest of the batch and caller_runs runs them one at a time until there is
+         * room again.
+         */
+        void push_ready_tasks( task_options const& options, std::vector< task_proxy >& proxies )
+        {
+            unsigned const level = level_of( options.priority );
+            for ( auto& proxy : proxies )
+            {
+                proxy.priority = level;
+                proxy.stop     = options.stop;
+                proxy.deadline = options.deadline;
+            }
+            auto       first = proxies.begin();
+            auto const last  = proxies.end();
+            while ( first != last )
+            {
+                auto const remaining = static_cast< std::size_t >( last - first );
+                if ( room_for( remaining ) == 0U )
+                {
+                    switch ( admit_tasks( std::min( remaining, queue_capacity_ ), true ) )
+                    {
+                    case admission::reject:
+                        proxies.clear();
+                        return;
+                    case admission::run_inline:
+                        run_inline( std::move( *first++ ) );
+                        continue;
+                    default:
+                        break;
+                    }
+                }
+                // admitted tasks are queued even if others took the room in the meantime
+                auto const chunk = static_cast< std::ptrdiff_t >(
+                    std::max< std::size_t >( room_for( remaining ), 1U ) );
+                push_ready_chunk( options.launch, first, first + chunk );
+                first += chunk;
+            }
+        }
+
+        /**
+         * @brief Queues a chunk of ready tasks of the same options with a single push onto the
+         * shared queue of their priority
+         *
+         * @details Workers of a work stealing pool push chunks of normal priority without a
+         * deadline onto their own deque instead, pools grouping threads by node onto the queue of
+         * the node of the caller. Sleepers are counted under tasks_mutex_ so at most one of them
+         * is woken per task.
+         */
+        void push_ready_chunk( std::launch const                            launch,
+                               typename std::vector< task_proxy >::iterator first,
+                               typename std::vector< task_proxy >::iterator last )
+        {
+            auto const count = static_cast< std::size_t >( last - first );
+            if ( launch != std::launch::async )
+            {
+                std::unique_lock< std::mutex > lock( deferred_mutex_ );
+                for ( auto it = first; it != last; ++it )
+                {
+                    deferred_.push( std::move( *it ) );
+                }
+                deferred_queued_ += count;
+                return;
+            }
+            std::size_t           wakeups = 0U;
+            worker_context const& worker  = this_worker();
+            unsigned const        level   = first->priority;
+            detail::stats_timer const queued{};
+            for ( auto it = first; it != last; ++it )
+            {
+                it->queued = queued;
+            }
+            bool const shared = level != normal_level() || first->has_deadline();
+            bool const local  = !shared && is_work_stealing() && worker.runtime == this;
+            if ( local || ( !shared && !node_queues_.empty() ) )
+            {
+                unsigned const           slot    = local ? worker.index : node_of_caller();
+                auto&                    queues  = local ? worker_queues_ : node_queues_;
+                worker_queue&            queue   = queues[slot];
+                detail::sharded_counter& counter = local ? tasks_local_ : tasks_node_;
+                {
+                    std::unique_lock< std::mutex > lock( queue.mutex_ );
+                    for ( auto it = first; it != last; ++it )
+                    {
+                        queue.tasks_.push_back( std::move( *it ) );
+                    }
+                    counter.add( slot, static_cast< std::ptrdiff_t >( count ) );
+                }
+            }
+            else
+            {
+                count_shared_tasks( level, count );
+                tasks_[level].push( first, last );
+            }
+            {
+                std::unique_lock< std::mutex > lock( tasks_mutex_ );
+                wakeups = std::min< std::size_t >( count, sleeping_.load() );
+            }
+            for ( std::size_t i = 0; i < wakeups; ++i )
+            {
+                task_added_.notify_one();
+            }
+        }
+
+        /**
+         * @brief Parks a task until every argument has notified that it is ready
+         *
+         * @param proxy     - the task
+         * @param arguments - the number of arguments of the task
+         * @param subscribe - registers the given continuation on every argument of the task
+         */
+        void park_task( task_proxy                proxy,
+                        std::size_t const         arguments,
+                        void ( *subscribe )( void*, continuation const& ) )
+        {
+            if ( is_full() && admit_tasks( 1U, false ) == admission::reject )
+            {
+                return;
+            }
+            void*        task{ nullptr };
+            parked_task* parked{ nullptr };
+            {
+                std::unique_lock< std::mutex > lock( parked_mutex_ );
+                parked_.emplace_front( *this, std::move( proxy ), arguments + 1U );
+                parked            = &parked_.front();
+                parked->position_ = parked_.begin();
+                task              = parked->proxy_.get(); // inline tasks moved with the proxy
+                ++tasks_waiting_;
+            }
+            continuation const next{ &parked_task::argument_ready, parked };
+            subscribe( task, next );
+            next();
+        }
 
-        explicit pool_runtime( std::chrono::nanoseconds latency, unsigned int requested_count )
-            : thread_count_( compute_thread_count( requested_count ) )
-            , threads_( std::make_unique< std::thread[] >( thread_count_ ) ) // NOLINT (c-arrays)
-            , task_check_latency_( latency )
+        /**
+         * @brief Moves a parked task whose arguments are all ready into the ready queue
+         */
+        void unpark_task( parked_task& parked )
         {
-            create_threads();
+            std::unique_lock< std::mutex > lock( parked_mutex_ );
+            if ( parking_closed_ )
+            {
+                return;
+            }
+            task_proxy proxy( std::move( parked.proxy_ ) );
+            parked_.erase( parked.position_ );
+            lock.unlock();
+            push_ready_task( std::move( proxy ) );
+            --tasks_waiting_;
+            notify_waiters();
         }
-        ~pool_runtime() { destroy_threads(); }
-        pool_runtime( pool_runtime const& ) = delete;
-        pool_runtime& operator=( pool_runtime const& ) = delete;
-        pool_runtime( pool_runtime&& )                 = delete;
-        pool_runtime& operator=( pool_runtime&& ) = delete;
 
-        void create_threads()
+        /**
+         * @brief Pushes a task onto the deque of a thread or node group counted in the given slot
+         */
+        void push_queue_task( worker_queue&            queue,
+                              detail::sharded_counter& counter,
+                              unsigned const           slot,
+                              task_proxy               proxy )
         {
-            abort_   = false;
-            threads_ = std::make_unique< std::thread[] >( thread_count_ ); // NOLINT (c-arrays)
-            for ( unsigned i = 0; i < thread_count_; ++i )
             {
-                threads_[i] = std::thread(
-                    &task_pool_t::pool_runtime::thread_worker, this, task_check_latency_ );
+                std::unique_lock< std::mutex > lock( queue.mutex_ );
+                queue.tasks_.push_back( std::move( proxy ) );
+                counter.add( slot, 1 );
             }
+            notify_sleeper();
         }
 
-        void destroy_threads()
+        /**
+         * @brief Wakes a sleeping thread after a task counter was raised, if there is any
+         *
+         * @details Sleepers register in `sleeping_` before testing the counters and we test
+         * `sleeping_` after incrementing a counter so at least one side will see the other.
+         * Taking the tasks_mutex_ before notifying ensures a sleeper that has registered is also
+         * waiting on the condition.
+         */
+        void notify_sleeper()
         {
+            if ( sleeping_.load() != 0U )
             {
-                std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
-                abort_ = true;
-                task_added_.notify_all();
+                std::unique_lock< std::mutex > lock( tasks_mutex_ );
+                task_added_.notify_one();
             }
-            for ( unsigned i = 0; i < thread_count_; ++i )
+        }
+
+        /**
+         * @brief Executes a task that was taken off a queue by the thread with the given index
+         */
+        void run_task( unsigned const index, task_proxy proxy )
+        {
+            notify_submitters();
+            // threads outside the pool helping in wait() share the helper counters
+            worker_counters& counters =
+                index < worker_counters_.size() ? worker_counters_[index] : helper_counters_;
+            worker_counters::add( counters.queue_wait_ns_, proxy.queued.elapsed() );
+            detail::stats_timer const busy{};
             {
-                if ( threads_[i].joinable() )
+                running_scope const scope( *this, proxy );
+                if ( scope.worker.expired )
                 {
-                    threads_[i].join();
+                    worker_counters::add( counters.deadline_misses_, std::uint64_t{ 1 } );
                 }
+                proxy.execute_task( proxy.get() );
             }
-            threads_.reset(); //  NOLINT (c-arrays)
-            thread_count_ = 0;
+            worker_counters::add( counters.busy_ns_, busy.elapsed() );
+            worker_counters::add( counters.tasks_executed_, std::uint64_t{ 1 } );
+            tasks_running_.add( index, -1 );
+            notify_waiters();
         }
 
-        void abort() { destroy_threads(); }
-
-        static unsigned compute_thread_count( const unsigned thread_count ) noexcept
+        /**
+         * @brief Wakes threads in wait() after the task counters where lowered
+         *
+         * @details Waiters test the counters under tasks_mutex_ so taking it here means they are
+         * either going to see the new counts or are already waiting on the condition.
+         */
+        void notify_waiters()
         {
-            // we need at least two threads to process work and check futures
-            if ( thread_count > 0 )
-            {
-                return thread_count;
-            }
-            else
+            if ( waiting_ )
             {
-                if ( std::thread::hardware_concurrency() > 0 )
-                {
-                    return std::thread::hardware_concurrency();
-                }
-                else
                 {
-                    return 1;
+                    std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
                 }
+                task_completed_.notify_all();
             }
         }
 
-        void wait() noexcept
+        /**
+         * @brief Pops and runs the newest task of the deque owned by the calling thread
+         */
+        bool run_local_task( unsigned const index )
         {
-            waiting_ = true;
-            try
+            worker_queue&                  queue = worker_queues_[index];
+            std::unique_lock< std::mutex > lock( queue.mutex_ );
+            if ( queue.tasks_.empty() )
             {
-                std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
-                task_added_.notify_all();
-                task_completed_.wait( tasks_lock, [this] {
-                    if ( paused_ )
-                    {
-                        return true;
-                    }
-                    return ( tasks_queued_ + tasks_running_ + tasks_waiting_ == 0 );
-                } );
+                return false;
             }
-            catch ( std::system_error const& e ) // std::mutex::lock may throw
+            task_proxy proxy( std::move( queue.tasks_.back() ) );
+            queue.tasks_.pop_back();
+            // counted as running first so the total never drops to zero in between
+            tasks_running_.add( index, 1 );
+            tasks_local_.add( index, -1 );
+            lock.unlock();
+            run_task( index, std::move( proxy ) );
+            return true;
+        }
+
+        /**
+         * @brief Runs the oldest task queued in the given node group
+         */
+        bool run_node_task( unsigned const index, unsigned const node )
+        {
+            if ( tasks_node_.load( node ) == 0U )
             {
-                // TODO: implement user logging facility
+                return false;
+            }
+            worker_queue&                  queue = node_queues_[node];
+            std::unique_lock< std::mutex > lock( queue.mutex_ );
+            if ( queue.tasks_.empty() )
+            {
+                return false;
             }
-            waiting_ = false;
+            task_proxy proxy( std::move( queue.tasks_.front() ) );
+            queue.tasks_.pop_front();
+            tasks_running_.add( index, 1 );
+            tasks_node_.add( node, -1 );
+            lock.unlock();
+            run_task( index, std::move( proxy ) );
+            return true;
         }
 
-        std::future_status wait_for( std::chrono::steady_clock::duration duration ) noexcept
+        bool is_same_node( unsigned const lhs, unsigned const rhs ) const noexcept
         {
-            return wait_until( std::chrono::steady_clock::now() + duration );
+            return node_queues_.empty() || worker_nodes_[lhs] == worker_nodes_[rhs];
         }
 
-        std::future_status wait_until( std::chrono::steady_clock::time_point deadline ) noexcept
+        /**
+         * @brief Runs a task of another thread or node group
+         *
+         * @details Deques of threads in the same node group are tried first, then the queues of
+         * the other node groups and only then the deques of their threads.
+         */
+        bool run_stolen_task( unsigned const index )
         {
-            waiting_ = true;
-            try
+            return steal_task( index, true ) || run_remote_node_task( index ) ||
+                   steal_task( index, false );
+        }
+
+        /**
+         * @brief Runs a task queued in another node group, the own group being out of work
+         */
+        bool run_remote_node_task( unsigned const index )
+        {
+            auto const groups = static_cast< unsigned >( node_queues_.size() );
+            if ( groups < 2U || tasks_node_.load() == 0U )
             {
-                std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
-                task_added_.notify_all();
-                auto stop_waiting = [this] {
-                    if ( paused_ )
-                    {
-                        return true;
-                    }
-                    return ( tasks_queued_ + tasks_running_ + tasks_waiting_ == 0 );
-                };
-                while ( !stop_waiting() )
-                {
-                    switch ( task_completed_.wait_until( tasks_lock, deadline ) )
-                    {
-                    case std::cv_status::timeout: {
-                        waiting_ = false;
-                        return std::future_status::timeout;
-                    }
-                    default:
-                        continue;
-                    }
-                }
+                return false;
             }
-            catch ( std::system_error const& e ) // std::mutex::lock may throw
+            unsigned const own = worker_nodes_[index];
+            for ( unsigned i = 1; i < groups; ++i )
             {
-                // TODO: implement user logging facility
+                if ( run_node_task( index, ( own + i ) % groups ) )
+                {
+                    return true;
+                }
             }
-            waiting_ = false;
-            return std::future_status::ready;
+            return false;
         }
 
-        void push_task( std::launch launch, task_proxy proxy )
+        /**
+         * @brief Steals and runs the oldest task of a thread in the same or in other node groups
+         * starting at a random victim
+         */
+        bool steal_task( unsigned const index, bool const same_node )
         {
-            if ( proxy.storage.get() == nullptr ) // NOLINT
+            // threads outside the pool belong to no node group and steal from any thread
+            bool const external = index == thread_capacity_;
+            if ( tasks_local_.load() == 0U || ( thread_capacity_ < 2 && !external ) ||
+                 ( !same_node && ( node_queues_.empty() || external ) ) )
             {
-                throw std::invalid_argument{ "'add_task' called with invalid task_proxy" };
+                return false;
             }
-            if ( launch == std::launch::async )
+            // xorshift32, cheap and good enough to spread thieves over their victims
+            std::uint32_t& random = this_worker().random;
+            random ^= random << 13U;
+            random ^= random >> 17U;
+            random ^= random << 5U;
+            unsigned const first = random % thread_capacity_;
+            for ( unsigned i = 0; i < thread_capacity_; ++i )
             {
-                if ( proxy.check_task( proxy.storage.get() ) )
+                unsigned const victim = ( first + i ) % thread_capacity_;
+                if ( victim == index ||
+                     ( !external && is_same_node( index, victim ) != same_node ) )
                 {
-                    std::unique_lock< std::mutex > lock( tasks_mutex_ );
-                    tasks_.push( std::move( proxy ) );
-                    ++tasks_queued_;
+                    continue;
                 }
-                else
+                worker_queue&                  queue = worker_queues_[victim];
+                std::unique_lock< std::mutex > lock( queue.mutex_, std::try_to_lock );
+                if ( !lock.owns_lock() || queue.tasks_.empty() )
                 {
-                    std::unique_lock< std::mutex > lock( check_tasks_mutex_ );
-                    tasks_to_check_.push_back( std::move( proxy ) );
-                    ++tasks_waiting_;
+                    continue;
                 }
-                task_added_.notify_one();
+                task_proxy proxy( std::move( queue.tasks_.front() ) );
+                queue.tasks_.pop_front();
+                tasks_running_.add( index, 1 );
+                tasks_local_.add( victim, -1 );
+                lock.unlock();
+                run_task( index, std::move( proxy ) );
+                return true;
             }
-            else
+            return false;
+        }
+
+        /**
+         * @brief Whether there are tasks to poll but no thread sleeping until the next poll
+         */
+        bool needs_poll_watch() const noexcept { return tasks_polled_.load() != 0U && !poll_watch_; }
+
+        /**
+         * @brief Picks the shard of the next lazy task submitted by the calling thread
+         *
+         * @details Tasks can not be spread by their address as the inline storage of task proxies
+         * gives every task submitted from one call site the same one.
+         */
+        check_shard& next_shard() noexcept
+        {
+            worker_context& worker = this_worker();
+            auto const      index  = worker.runtime == this ? worker.index : 0U;
+            return check_shards_[( index + worker.polled++ ) % check_shards_.size()];
+        }
+
+        /**
+         * @brief Checks the shards of the tasks polled for their lazy arguments that no other
+         * thread is checking, starting with the shard of the calling thread
+         */
+        void check_waiting_tasks( unsigned const index, worker_counters& counters )
+        {
+            for ( std::size_t offset = 0; offset < check_shards_.size(); ++offset )
             {
-                std::unique_lock< std::mutex > lock( deferred_mutex_ );
-                deferred_.push( std::move( proxy ) );
-                ++deferred_queued_;
+                check_shard& shard = check_shards_[( index + offset ) % check_shards_.size()];
+                if ( shard.waiting_.load() == 0U )
+                {
+                    continue;
+                }
+                std::unique_lock< std::mutex > lock( shard.mutex_, std::try_to_lock );
+                if ( !lock.owns_lock() )
+                {
+                    continue;
+                }
+                detail::stats_timer const checking{};
+                std::vector< task_proxy > ready_tasks = task_checker( shard );
+                lock.unlock();
+                for ( task_proxy& proxy_ready : ready_tasks )
+                {
+                    push_ready_task( std::move( proxy_ready ) );
+                    --tasks_polled_;
+                    --tasks_waiting_;
+                }
+                if ( !ready_tasks.empty() )
+                {
+                    notify_waiters();
+                }
+                worker_counters::add( counters.checker_ns_, checking.elapsed() );
             }
         }
 
-        // must run with waiting_task_mutex held
-        std::vector< task_proxy > task_checker()
+        /**
+         * @brief Takes the tasks whose lazy arguments became ready out of the next check_batch_
+         * tasks of the shard, must run with the mutex of the shard held
+         *
+         * @details Each check continues where the last one stopped and wraps around at the end so
+         * every task is checked once per round however many tasks wait. Tasks stay in the order
+         * they started waiting, oldest first as their arguments were usually started earlier.
+         * Tasks remember which of their arguments were ready so checking a task costs a single
+         * argument until it made progress.
+         */
+        std::vector< task_proxy > task_checker( check_shard& shard )
         {
             if ( abort_ )
             {
                 return {};
             }
-            std::vector< task_proxy > ready_tasks;
+            std::vector< task_proxy >  ready_tasks;
+            std::vector< task_proxy >& tasks = shard.tasks_;
+            if ( shard.cursor_ >= tasks.size() )
             {
-                auto const start   = std::begin( tasks_to_check_ );
-                auto const stop    = std::end( tasks_to_check_ );
-                auto const removed = std::partition( start, stop, []( task_proxy const& proxy ) {
-                    return !proxy.check_task( proxy.storage.get() );
-                } );
-                ready_tasks.insert( ready_tasks.end(),
-                                    std::make_move_iterator( removed ),
-                                    std::make_move_iterator( stop ) );
-                tasks_to_check_.erase( removed, tasks_to_check_.end() );
+                shard.cursor_ = 0;
             }
+            std::size_t const count = std::min( check_batch_, tasks.size() - shard.cursor_ );
+            auto const        first =
+                std::next( tasks.begin(), static_cast< std::ptrdiff_t >( shard.cursor_ ) );
+            auto const last = std::next( first, static_cast< std::ptrdiff_t >( count ) );
+            auto const removed = std::stable_partition(
+                first, last, []( task_proxy const& proxy ) { return !proxy.is_ready(); } );
+            shard.cursor_ += static_cast< std::size_t >( std::distance( first, removed ) );
+            ready_tasks.insert( ready_tasks.end(),
+                                std::make_move_iterator( removed ),
+                                std::make_move_iterator( last ) );
+            tasks.erase( removed, last );
+            shard.waiting_ -= ready_tasks.size();
             return ready_tasks;
         }
 
         void invoke_deferred()
         {
+            worker_context const& worker = this_worker();
+            std::size_t const     slot =
+                worker.runtime == this ? worker.index : tasks_running_.size() - 1U;
             std::queue< task_proxy > tasks;
             {
                 std::unique_lock< std::mutex > deferred_lock( deferred_mutex_ );
                 std::swap( tasks, deferred_ );
                 deferred_queued_ = 0;
             }
+            notify_submitters();
             while ( !tasks.empty() )
             {
                 task_proxy proxy( std::move( tasks.front() ) );
                 tasks.pop();
-                if ( proxy.check_task( proxy.storage.get() ) )
+                if ( proxy.is_ready() )
                 {
-                    ++tasks_running_;
-                    proxy.execute_task( proxy.storage.get() );
-                    --tasks_running_;
+                    tasks_running_.add( slot, 1 );
+                    {
+                        running_scope const scope( *this, proxy );
+                        proxy.execute_task( proxy.get() );
+                    }
+                    tasks_running_.add( slot, -1 );
                 }
                 else
                 {
-                    push_task( std::launch::deferred, std::move( proxy ) );
+                    queue_task( std::launch::deferred, std::move( proxy ) );
+                }
+            }
+        }
+
+        /**
+         * @brief Spins and yields according to the idle policy while there is no work
+         *
+         * @return true if work showed up
+         */
+        bool idle_wait() const
+        {
+            unsigned const spins  = idle_ == idle_policy::latency ? 4096U : 32U;
+            unsigned const yields = idle_ == idle_policy::latency ? 32U : 0U;
+
+            auto has_work = [this] {
+                return abort_ || ( !paused_ && tasks_queued() != 0U );
+            };
+            for ( unsigned i = 0; i < spins; ++i )
+            {
+                if ( has_work() )
+                {
+                    return true;
+                }
+                detail::cpu_relax();
+            }
+            for ( unsigned i = 0; i < yields; ++i )
+            {
+                if ( has_work() )
+                {
+                    return true;
+                }
+                std::this_thread::yield();
+            }
+            return has_work();
+        }
+
+        /**
+         * @brief Entry point of the threads, applies the thread options around thread_worker
+         */
+        void run_worker( unsigned const index, std::chrono::nanoseconds const latency )
+        {
+            if ( !node_queues_.empty() )
+            {
+                detail::pin_current_thread( topology_[worker_nodes_[index]].cpus );
+            }
+            detail::configure_thread( thread_options_, index );
+            if ( thread_options_.on_start )
+            {
+                thread_options_.on_start( index );
+            }
+            thread_worker( index, latency );
+            if ( thread_options_.on_stop )
+            {
+                thread_options_.on_stop( index );
+            }
+        }
+
+        /**
+         * @brief Runs the next queued task in the slot of the calling thread, returns false if
+         * there was none
+         *
+         * @details Threads of the pool take tasks off their own deque and node group first,
+         * threads outside of it only help with the shared queues, node groups and deques.
+         */
+        bool run_next_task( unsigned const index )
+        {
+            if ( index == thread_capacity_ )
+            {
+                if ( paused_ || abort_ )
+                {
+                    return false;
+                }
+                if ( next_shared_level() <= normal_level() && run_shared_task( index ) )
+                {
+                    return true;
+                }
+                for ( unsigned node = 0; node < node_queues_.size(); ++node )
+                {
+                    if ( run_node_task( index, node ) )
+                    {
+                        return true;
+                    }
                 }
+                return steal_task( index, true ) || run_shared_task( index );
+            }
+            if ( is_work_stealing() && !paused_ && !has_urgent_tasks() && run_local_task( index ) )
+            {
+                return true;
             }
+            if ( !node_queues_.empty() && !paused_ && !has_urgent_tasks() &&
+                 run_node_task( index, worker_nodes_[index] ) )
+            {
+                return true;
+            }
+            // stolen tasks are of normal priority and go ahead of lower priority shared tasks
+            if ( ( is_work_stealing() || node_queues_.size() > 1U ) && !paused_ &&
+                 next_shared_level() > normal_level() && run_stolen_task( index ) )
+            {
+                return true;
+            }
+            return run_shared_task( index );
+        }
+
+        /**
+         * @brief Runs a task for a thread of the pool waiting on a be::future, see
+         * detail::task_helper
+         */
+        static bool help_waiting_thread( void* runtime )
+        {
+            auto* self = static_cast< pool_runtime* >( runtime );
+            return !self->abort_ && self->run_next_task( this_worker().index );
         }
 
         /**
@@ -1359,76 +4651,147 @@ private:
          * the ready.
          *
          * At the head of the worker function we check if there are waiting tasks that need
-         * checking and if so exactly one thread gets the job to update the statuses and
-         * resubmit tasks that are ready for processing.
+         * checking and if so the thread checks every shard of them that no other thread is
+         * checking, resubmitting the tasks that are ready for processing.
          *
          * The idea would be that there is always some thread waiting on the tasks_mutex_ so
          * there is probably no rush to get there so before we try to take it and start waiting
          * ourselves we spend some time checking the input args for tasks that uses futures.
          * Once we have checked the futures we wake up any waiting thread to be the next
          * task_checker .
+         *
+         * When work stealing the thread first drains its own deque, then the shared injection
+         * queue and only then tries to steal from other threads before going to sleep.
          */
-        void thread_worker( std::chrono::nanoseconds latency )
+        void thread_worker( unsigned const index, std::chrono::nanoseconds latency )
         {
+            this_worker() = worker_context{ this, index, index + 1U };
+            // waiting threads look for tasks again after 50us if there was none
+            detail::this_thread_helper() = detail::task_helper{
+                &help_waiting_thread, this, std::chrono::microseconds( 50 ) };
+            worker_counters& counters = worker_counters_[index];
             for ( ;; )
             {
+                if ( has_surplus_threads() &&
+                     ( !is_work_stealing() || tasks_local_.load( index ) == 0U ) &&
+                     retire_thread( index ) )
+                {
+                    return;
+                }
+                // thread_workers first check the timers and waiting tasks no other thread is
+                // checking
+                if ( timers_due() )
                 {
-                    // thread_workers first tries to become the next task_checker
-                    std::unique_lock< std::mutex > lock( check_tasks_mutex_, std::try_to_lock );
-                    if ( lock.owns_lock() && ( tasks_waiting_.load() != 0U ) )
+                    detail::stats_timer const checking{};
+                    for ( task_proxy& proxy_expired : expire_timers() )
                     {
-                        std::vector< task_proxy > ready_tasks = task_checker();
-                        for ( task_proxy& proxy_ready : ready_tasks )
-                        {
-                            push_task( std::launch::async, std::move( proxy_ready ) );
-                            --tasks_waiting_;
-                        }
+                        push_ready_task( std::move( proxy_expired ) );
                     }
+                    worker_counters::add( counters.checker_ns_, checking.elapsed() );
+                }
+                if ( tasks_polled_.load() != 0U )
+                {
+                    check_waiting_tasks( index, counters );
+                }
+                if ( run_next_task( index ) )
+                {
+                    continue;
                 }
                 std::unique_lock< std::mutex > tasks_lock( tasks_mutex_ );
                 if ( abort_ )
                 {
                     break;
                 }
-                using namespace std::chrono_literals;
-                if ( tasks_waiting_.load() != 0U )
+                auto has_tasks = [this] {
+                    if ( abort_ )
+                    {
+                        return true;
+                    }
+                    if ( paused_ )
+                    {
+                        return false;
+                    }
+                    return tasks_queued() != 0U;
+                };
+                detail::stats_timer const idle{};
+                bool const                going_idle = !has_tasks();
+                if ( going_idle )
+                {
+                    tasks_lock.unlock();
+                    if ( idle_wait() )
+                    {
+                        worker_counters::add( counters.idle_ns_, idle.elapsed() );
+                        continue;
+                    }
+                    tasks_lock.lock();
+                }
+                auto has_tasks_or_surplus = [&] { return has_tasks() || has_surplus_threads(); };
+                bool idle_expired         = false;
+                ++sleeping_;
+                if ( needs_timer_watch() )
+                {
+                    // one thread sleeps until the next timer, woken early if one is added before
+                    timer_watch_                = true;
+                    std::uint64_t const watched = next_timer_tick_.load();
+                    task_added_.wait_until( tasks_lock, tick_time( watched ), [&] {
+                        return has_tasks_or_surplus() || next_timer_tick_.load() < watched;
+                    } );
+                    timer_watch_ = false;
+                    // another sleeper watches the timers while this thread expires them
+                    task_added_.notify_one();
+                }
+                else if ( needs_poll_watch() )
+                {
+                    // lazy arguments that can not notify have to be polled, by one thread at a
+                    // time while the others sleep until there is work
+                    poll_watch_ = true;
+                    task_added_.wait_for( tasks_lock, latency, has_tasks_or_surplus );
+                    poll_watch_ = false;
+                    // another sleeper polls while this thread checks the tasks
+                    task_added_.notify_one();
+                }
+                else if ( thread_count_ > min_threads_ )
                 {
-                    task_added_.wait_for(
-                        tasks_lock, latency, [this] { return !tasks_.empty() || abort_; } );
+                    // threads above the minimum exit once they were idle for keep_alive_
+                    idle_expired = !task_added_.wait_for( tasks_lock, keep_alive_, [&] {
+                        return has_tasks_or_surplus() || needs_poll_watch() ||
+                               needs_timer_watch();
+                    } );
                 }
                 else
                 {
-                    task_added_.wait_for( tasks_lock, std::chrono::milliseconds( 1 ), [this] {
-                        bool has_tasks = !tasks_.empty();
-                        return has_tasks || abort_;
+                    // also wake up for tasks that have to be polled and timers nobody watches
+                    task_added_.wait( tasks_lock, [&] {
+                        return has_tasks() || needs_poll_watch() || needs_timer_watch();
                     } );
                 }
+                --sleeping_;
+                if ( going_idle )
+                {
+                    worker_counters::add( counters.idle_ns_, idle.elapsed() );
+                    worker_counters::add( counters.wakeups_, std::uint64_t{ 1 } );
+                    if ( !has_tasks() )
+                    {
+                        worker_counters::add( counters.spurious_wakeups_, std::uint64_t{ 1 } );
+                    }
+                }
                 if ( abort_ )
                 {
                     return;
                 }
-                if ( tasks_.empty() )
+                if ( ( idle_expired || has_surplus_threads() ) && !has_tasks() )
                 {
-                    // we where woken to be the next task_checker
-                    if ( waiting_ )
+                    tasks_lock.unlock();
+                    if ( ( !is_work_stealing() || tasks_local_.load( index ) == 0U ) &&
+                         retire_thread( index ) )
                     {
-                        task_completed_.notify_one();
+                        return;
                     }
                     continue;
                 }
-                if ( paused_ )
-                {
-                    continue;
-                }
-                task_proxy proxy( std::move( tasks_.front() ) );
-                tasks_.pop();
-                --tasks_queued_;
-                ++tasks_running_;
-                tasks_lock.unlock();
-                proxy.execute_task( proxy.storage.get() );
-                --tasks_running_;
-                if ( waiting_ )
+                if ( tasks_shared_.load() == 0U && waiting_ )
                 {
+                    // we where woken to be the next task_checker or to steal work
                     task_completed_.notify_one();
                 }
             }
@@ -1440,4 +4803,59 @@ private:
 
 using task_pool = task_pool_t< std::allocator< void > >;
 extern template class task_pool_t< std::allocator< void > >;
+
+/**
+ * @brief Returns a future for a tuple of the values of all futures once the last is ready
+ *
+ * @details The tuple is built by a pool task that is parked until every future has notified,
+ * futures that can not notify are polled.
+ *
+ * @code{.cpp}
+ * auto both = be::when_all( pool, std::move( header ), std::move( body ) );
+ * auto page = pool.then( std::move( both ), &render );
+ * @endcode
+ */
+template< typename Allocator,
+          typename ReadyQueue,
+          typename Future,
+          typename... Futures,
+          std::enable_if_t< is_future< std::decay_t< Future > >::value, bool > = true >
+auto when_all( task_pool_t< Allocator, ReadyQueue >& pool, Future&& future, Futures&&... futures )
+{
+    return pool.template submit< be::promise >(
+        std::launch::async,
+        []( future_value_t< std::decay_t< Future > > value,
+            future_value_t< std::decay_t< Futures > >... values ) {
+            return std::make_tuple( std::move( value ), std::move( values )... );
+        },
+        std::forward< Future >( future ),
+        std::forward< Futures >( futures )... );
+}
+
+/**
+ * @brief See task_pool_t::when_all
+ */
+template< typename Allocator, typename ReadyQueue, typename T >
+auto when_all( task_pool_t< Allocator, ReadyQueue >& pool, std::vector< be::future< T > > futures )
+{
+    return pool.when_all( std::move( futures ) );
+}
+
+/**
+ * @brief Returns a future for the futures and the index of the first of them that became ready
+ */
+template< typename Allocator, typename ReadyQueue, typename... Ts >
+auto when_any( task_pool_t< Allocator, ReadyQueue >& pool, be::future< Ts >... futures )
+{
+    return pool.when_any( std::make_tuple( std::move( futures )... ) );
+}
+
+/**
+ * @brief See task_pool_t::when_any
+ */
+template< typename Allocator, typename ReadyQueue, typename T >
+auto when_any( task_pool_t< Allocator, ReadyQueue >& pool, std::vector< be::future< T > > futures )
+{
+    return pool.when_any( std::move( futures ) );
+}
 } // namespace be
@@ -0,0 +1,350 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <task_pool/api.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace be {
+
+namespace detail {
+constexpr std::size_t cache_line_size = 64;
+
+/**
+ * @brief Separates the members around it onto different cache lines
+ *
+ * @details Used instead of alignas since C++14 does not over-align heap allocations such as the
+ * pool runtime.
+ */
+using cache_line_padding = std::array< char, cache_line_size >;
+} // namespace detail
+
+/**
+ * @brief Unbounded FIFO queue guarded by a mutex, the default ready queue of task_pool_t
+ */
+template< typename T >
+class locked_queue
+{
+public:
+    void push( T value )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        items_.push_back( std::move( value ) );
+    }
+
+    /**
+     * @brief Moves the values of [first, last) into the queue with a single lock acquisition
+     */
+    template< typename Iterator >
+    void push( Iterator first, Iterator last )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        for ( ; first != last; ++first )
+        {
+            items_.push_back( std::move( *first ) );
+        }
+    }
+
+    /**
+     * @brief Moves the oldest value into the given one, returns false if the queue is empty
+     */
+    bool try_pop( T& value )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        if ( items_.empty() )
+        {
+            return false;
+        }
+        value = std::move( items_.front() );
+        items_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex      mutex_ = {};
+    std::deque< T > items_;
+};
+
+/**
+ * @brief Queue guarded by a mutex handing out the value with the earliest deadline first
+ *
+ * @details Values are ordered by their `deadline` member. Values with equal deadlines, including
+ * those without one whose deadline is the latest time point, leave in the order they were pushed.
+ * Pushing and popping are logarithmic in the number of values queued.
+ */
+template< typename T >
+class deadline_queue
+{
+public:
+    void push( T value )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        push_locked( std::move( value ) );
+    }
+
+    /**
+     * @brief Moves the values of [first, last) into the queue with a single lock acquisition
+     */
+    template< typename Iterator >
+    void push( Iterator first, Iterator last )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        for ( ; first != last; ++first )
+        {
+            push_locked( std::move( *first ) );
+        }
+    }
+
+    /**
+     * @brief Moves the value with the earliest deadline into the given one, returns false if the
+     * queue is empty
+     */
+    bool try_pop( T& value )
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        if ( items_.empty() )
+        {
+            return false;
+        }
+        std::pop_heap( items_.begin(), items_.end(), &later );
+        value = std::move( items_.back().value );
+        items_.pop_back();
+        return true;
+    }
+
+private:
+    using deadline_type = std::decay_t< decltype( std::declval< T const& >().deadline ) >;
+
+    struct entry
+    {
+        deadline_type deadline;
+        std::uint64_t sequence;
+        T             value;
+    };
+
+    static bool later( entry const& lhs, entry const& rhs ) noexcept
+    {
+        return lhs.deadline != rhs.deadline ? rhs.deadline < lhs.deadline
+                                            : lhs.sequence > rhs.sequence;
+    }
+
+    void push_locked( T&& value )
+    {
+        deadline_type const deadline = value.deadline;
+        items_.push_back( entry{ deadline, sequence_++, std::move( value ) } );
+        std::push_heap( items_.begin(), items_.end(), &later );
+    }
+
+    std::mutex           mutex_ = {};
+    std::vector< entry > items_; // a heap with the earliest deadline at the front
+    std::uint64_t        sequence_ = 0;
+};
+
+/**
+ * @brief Bounded lock free multi producer multi consumer ring that spills into a locked_queue
+ * once it is full
+ *
+ * @details Follows Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence number
+ * telling producers and consumers whose turn it is so each side only contends on its own
+ * position. While values are in the overflow queue new values go there as well and consumers
+ * drain the ring before the overflow, which keeps the queue first in first out apart from
+ * values pushed concurrently with the ring filling up.
+ *
+ * @tparam Capacity - number of cells of the ring, a power of two
+ */
+template< typename T, std::size_t Capacity = 1024 >
+class mpmc_queue
+{
+    static_assert( Capacity >= 2U && ( Capacity & ( Capacity - 1U ) ) == 0U,
+                   "the capacity of mpmc_queue must be a power of two" );
+
+public:
+    mpmc_queue()
+        : cells_( new cell[Capacity] ) // NOLINT
+    {
+        for ( std::size_t i = 0; i < Capacity; ++i )
+        {
+            cells_[i].sequence_.store( i, std::memory_order_relaxed );
+        }
+    }
+
+    ~mpmc_queue()
+    {
+        // every push has completed by now so the cells between the positions hold values
+        std::size_t const last = enqueue_.load();
+        for ( std::size_t position = dequeue_.load(); position != last; ++position )
+        {
+            reinterpret_cast< T* >( &cells_[position & mask].storage_ )->~T(); // NOLINT
+        }
+    }
+
+    mpmc_queue( mpmc_queue const& ) = delete;
+    mpmc_queue& operator=( mpmc_queue const& ) = delete;
+
+    void push( T value )
+    {
+        if ( overflowed_.load() != 0U || !try_push( value ) )
+        {
+            ++overflowed_;
+            overflow_.push( std::move( value ) );
+        }
+    }
+
+    template< typename Iterator >
+    void push( Iterator first, Iterator last )
+    {
+        for ( ; first != last; ++first )
+        {
+            push( std::move( *first ) );
+        }
+    }
+
+    /**
+     * @brief Moves the oldest value into the given one, returns false if the queue is empty
+     */
+    bool try_pop( T& value )
+    {
+        if ( try_pop_ring( value ) )
+        {
+            return true;
+        }
+        if ( overflowed_.load() != 0U && overflow_.try_pop( value ) )
+        {
+            --overflowed_;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Pushes into the ring only, returns false leaving value untouched if it is full
+     */
+    bool try_push( T& value )
+    {
+        std::size_t position = enqueue_.load( std::memory_order_relaxed );
+        for ( ;; )
+        {
+            cell&             slot     = cells_[position & mask];
+            std::size_t const sequence = slot.sequence_.load( std::memory_order_acquire );
+            auto const        distance = static_cast< std::intptr_t >( sequence ) -
+                                  static_cast< std::intptr_t >( position );
+            if ( distance == 0 )
+            {
+                if ( enqueue_.compare_exchange_weak(
+                         position, position + 1U, std::memory_order_relaxed ) )
+                {
+                    ::new ( &slot.storage_ ) T( std::move( value ) );
+                    slot.sequence_.store( position + 1U, std::memory_order_release );
+                    return true;
+                }
+            }
+            else if ( distance < 0 )
+            {
+                return false;
+            }
+            else
+            {
+                position = enqueue_.load( std::memory_order_relaxed );
+            }
+        }
+    }
+
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+private:
+    static constexpr std::size_t mask = Capacity - 1U;
+
+    struct cell
+    {
+        std::atomic< std::size_t >                                  sequence_{ 0 };
+        typename std::aligned_storage< sizeof( T ), alignof( T ) >::type storage_;
+    };
+
+    bool try_pop_ring( T& value )
+    {
+        std::size_t position = dequeue_.load( std::memory_order_relaxed );
+        for ( ;; )
+        {
+            cell&             slot     = cells_[position & mask];
+            std::size_t const sequence = slot.sequence_.load( std::memory_order_acquire );
+            auto const        distance = static_cast< std::intptr_t >( sequence ) -
+                                  static_cast< std::intptr_t >( position + 1U );
+            if ( distance == 0 )
+            {
+                if ( dequeue_.compare_exchange_weak(
+                         position, position + 1U, std::memory_order_relaxed ) )
+                {
+                    T* stored = reinterpret_cast< T* >( &slot.storage_ ); // NOLINT
+                    value     = std::move( *stored );
+                    stored->~T();
+                    slot.sequence_.store( position + Capacity, std::memory_order_release );
+                    return true;
+                }
+            }
+            else if ( distance < 0 )
+            {
+                return false;
+            }
+            else
+            {
+                position = dequeue_.load( std::memory_order_relaxed );
+            }
+        }
+    }
+
+    std::unique_ptr< cell[] >  cells_; // NOLINT (c-arrays)
+    detail::cache_line_padding enqueue_padding_{};
+    std::atomic< std::size_t > enqueue_{ 0 };
+    detail::cache_line_padding dequeue_padding_{};
+    std::atomic< std::size_t > dequeue_{ 0 };
+    detail::cache_line_padding overflow_padding_{};
+    std::atomic< std::size_t > overflowed_{ 0 }; // values in overflow_
+    locked_queue< T >          overflow_;
+};
+
+/**
+ * @brief Ready queue policy of task_pool_t using a locked_queue per priority level
+ */
+struct locked_ready_queue
+{
+    template< typename T >
+    using queue_type = locked_queue< T >;
+};
+
+/**
+ * @brief Ready queue policy of task_pool_t using an mpmc_queue per priority level
+ *
+ * @code{.cpp}
+ * be::task_pool_t< std::allocator< void >, be::lock_free_ready_queue<> > pool( 16 );
+ * @endcode
+ */
+template< std::size_t Capacity = 1024 >
+struct lock_free_ready_queue
+{
+    template< typename T >
+    using queue_type = mpmc_queue< T, Capacity >;
+};
+
+/**
+ * @brief Ready queue policy of task_pool_t running the tasks of each priority level earliest
+ * deadline first, see task_options::deadline
+ *
+ * @code{.cpp}
+ * be::task_pool_t< std::allocator< void >, be::deadline_ready_queue > pool( 16 );
+ * @endcode
+ */
+struct deadline_ready_queue
+{
+    template< typename T >
+    using queue_type = deadline_queue< T >;
+};
+
+} // namespace be
@@ -0,0 +1,260 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <task_pool/api.h>
+#include <task_pool/fallbacks.h>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace be {
+
+namespace detail {
+/**
+ * @brief Callback registered with a stop_state, see be::stop_callback
+ */
+struct stop_callback_node
+{
+    void ( *invoke )( void* ) = nullptr;
+    void*            context  = nullptr;
+    std::atomic_bool fired{ false }; // the callback runs once even if registered twice
+
+    void run() noexcept
+    {
+        if ( !fired.exchange( true ) )
+        {
+            invoke( context );
+        }
+    }
+};
+
+/**
+ * @brief State shared by a stop_source and its stop_tokens
+ */
+class TASKPOOL_API stop_state
+{
+public:
+    bool stop_requested() const noexcept { return stopped_.load( std::memory_order_acquire ); }
+
+    /**
+     * @brief Sets the stop flag and runs the registered callbacks on the calling thread
+     *
+     * @return false if stop had already been requested
+     */
+    bool request_stop();
+
+    /**
+     * @brief Registers a callback, returns false without registering if stop was requested
+     */
+    bool add( stop_callback_node* callback );
+
+    /**
+     * @brief Removes a callback, waiting for it to return if another thread is running it
+     */
+    void remove( stop_callback_node* callback );
+
+private:
+    std::atomic_bool                 stopped_{ false };
+    std::mutex                       mutex_;
+    std::condition_variable          callback_done_;
+    std::list< stop_callback_node* > callbacks_;
+    stop_callback_node*              running_ = nullptr; // callback being run by request_stop
+    std::thread::id                  runner_;
+};
+} // namespace detail
+
+/**
+ * @brief Allows tasks to participate in cooperative cancellation
+ *
+ * @details Users may submit tasks that take a be::stop_token as its last
+ * argument and the task_pool will provide a token for the function when
+ * executing that may be used to break out of long running work.
+ *
+ * @code{.cpp}
+ * pool.submit( []( be::stop_token token ){ while( !token ) { //process things }
+ * );
+ * @endcode
+ *
+ * stop_tokens are a means to abort running operations and as such do not fire
+ * when the task_pool is trying to complete work using
+ * `task_pool::wait_for_tasks` however it does fire on destruction.
+ *
+ * @code{.cpp}
+ * {
+ *     task_pool pool;
+ *     auto f = pool.submit( []( be::stop_token token ){ while( !token ) {
+ * std::this_thread::sleep_for(1ms); } );
+ *     // pool.wait_for_tasks(); // <-- this would deadlock
+ * }                             // <-- destruction fires the stop token
+ * allowing task to complete
+ * @endcode
+ *
+ * Tokens come from a be::stop_source or from the pool. A task submitted with the token of a
+ * stop_source in its task_options receives a token that fires when either the source requests stop
+ * or the pool aborts. Default constructed tokens never fire.
+ */
+struct TASKPOOL_API stop_token
+{
+    stop_token() noexcept = default;
+    explicit stop_token( std::shared_ptr< detail::stop_state > state,
+                         std::shared_ptr< detail::stop_state > chained = {} ) noexcept
+        : state_( std::move( state ) )
+        , chained_( std::move( chained ) )
+    {
+    }
+
+    /**
+     * @brief Returns a token that also fires when the given one does
+     *
+     * @details Tokens chain a single other token, a token that already is chained is returned
+     * unchanged.
+     */
+    stop_token chain( stop_token const& other ) const noexcept
+    {
+        if ( !state_ || chained_ )
+        {
+            return state_ ? *this : other;
+        }
+        return stop_token( state_, other.state_ );
+    }
+
+    bool stop_requested() const noexcept
+    {
+        return ( state_ && state_->stop_requested() ) || ( chained_ && chained_->stop_requested() );
+    }
+
+    bool stop_possible() const noexcept { return state_ || chained_; }
+
+    explicit operator bool() const noexcept { return stop_requested(); }
+
+private:
+    template< typename Callback >
+    friend class stop_callback;
+
+    std::shared_ptr< detail::stop_state > state_;
+    std::shared_ptr< detail::stop_state > chained_;
+};
+
+/**
+ * @brief Owner of a stop state handing out tokens that fire once stop is requested
+ *
+ * @details Copies share the same state. One source per request or connection allows all the work
+ * submitted on its behalf to be cancelled without touching the rest of the pool.
+ *
+ * @code{.cpp}
+ * be::stop_source disconnected;
+ * auto reply = pool.submit( { std::launch::async, disconnected.get_token() }, &render, request );
+ * disconnected.request_stop(); // reply completes with be::task_cancelled unless it started
+ * @endcode
+ */
+class TASKPOOL_API stop_source
+{
+public:
+    stop_source()
+        : state_( std::make_shared< detail::stop_state >() )
+    {
+    }
+
+    BE_NODISGARD stop_token get_token() const noexcept { return stop_token( state_ ); }
+
+    /**
+     * @brief Fires the tokens of the source and runs their callbacks on the calling thread
+     *
+     * @return false if stop had already been requested
+     */
+    bool request_stop() { return state_->request_stop(); }
+
+    BE_NODISGARD bool stop_requested() const noexcept { return state_->stop_requested(); }
+
+private:
+    std::shared_ptr< detail::stop_state > state_;
+};
+
+/**
+ * @brief Invokes a callback when the token fires, immediately if it already has
+ *
+ * @details The callback runs at most once on the thread requesting stop. Destroying the
+ * stop_callback unregisters it and waits for the callback to return if it is running on another
+ * thread.
+ *
+ * @code{.cpp}
+ * be::stop_callback< std::function< void() > > close_socket( token, [&] { socket.close(); } );
+ * @endcode
+ */
+template< typename Callback >
+class stop_callback
+{
+public:
+    template< typename C,
+              std::enable_if_t< std::is_constructible< Callback, C >::value, bool > = true >
+    stop_callback( stop_token const& token, C&& callback )
+        : callback_( std::forward< C >( callback ) )
+        , states_{ token.state_, token.chained_ }
+    {
+        node_.invoke  = []( void* self ) { static_cast< stop_callback* >( self )->callback_(); };
+        node_.context = this;
+        for ( auto const& state : states_ )
+        {
+            if ( state && !node_.fired && !state->add( &node_ ) )
+            {
+                node_.run();
+            }
+        }
+    }
+    ~stop_callback()
+    {
+        for ( auto const& state : states_ )
+        {
+            if ( state )
+            {
+                state->remove( &node_ );
+            }
+        }
+    }
+    stop_callback( stop_callback const& ) = delete;
+    stop_callback& operator=( stop_callback const& ) = delete;
+    stop_callback( stop_callback&& )                 = delete;
+    stop_callback& operator=( stop_callback&& ) = delete;
+
+private:
+    detail::stop_callback_node            node_;
+    Callback                              callback_;
+    std::shared_ptr< detail::stop_state > states_[2]; // NOLINT (c-arrays)
+};
+
+/**
+ * @brief Exception stored in the future of a task that was cancelled before it started
+ */
+class TASKPOOL_API task_cancelled : public std::runtime_error
+{
+public:
+    task_cancelled()
+        : std::runtime_error( "the task was cancelled before it started" )
+    {
+    }
+
+protected:
+    explicit task_cancelled( char const* what )
+        : std::runtime_error( what )
+    {
+    }
+};
+
+/**
+ * @brief Exception stored in the future of a task whose deadline passed before it started, see
+ * task_options::deadline
+ */
+class TASKPOOL_API deadline_exceeded : public task_cancelled
+{
+public:
+    deadline_exceeded()
+        : task_cancelled( "the deadline of the task passed before it started" )
+    {
+    }
+};
+
+} // namespace be
@@ -0,0 +1,230 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <task_pool/api.h>
+#include <task_pool/fallbacks.h>
+#include <task_pool/stop_token.h>
+#include <utility>
+#include <vector>
+
+namespace be {
+
+/**
+ * @brief Cancels a timer of a task_pool, see task_pool_t::submit_after
+ *
+ * @details Copies refer to the same timer. Cancelling stops a periodic timer and drops the task
+ * of an expiry that has not started yet, running tasks see the token of the handle fire if they
+ * take a be::stop_token.
+ */
+class TASKPOOL_API timer_handle
+{
+public:
+    timer_handle() = default;
+    explicit timer_handle( stop_source source ) noexcept
+        : source_( std::move( source ) )
+    {
+    }
+
+    void cancel() { source_.request_stop(); }
+
+    BE_NODISGARD bool is_cancelled() const noexcept { return source_.stop_requested(); }
+
+    BE_NODISGARD stop_token get_stop_token() const noexcept { return source_.get_token(); }
+
+private:
+    stop_source source_;
+};
+
+namespace detail {
+/**
+ * @brief Hierarchical timer wheel holding values until the tick they are due at
+ *
+ * @details Four levels of 64 slots each. Level zero holds the values due within the current
+ * block of 64 ticks, one slot per tick, and every level above holds the values of the following
+ * blocks of its size within the current block of the level above. A slot of a higher level is
+ * cascaded into the levels below once the current tick enters its block, so adding and expiring
+ * are constant time and every value moves at most once per level. Values beyond the range of the
+ * wheel wait in an overflow list that is cascaded every 2^24 ticks.
+ *
+ * Ticks are counted by the owner, the wheel only ever moves forward.
+ */
+template< typename T >
+class timer_wheel
+{
+public:
+    using tick_type = std::uint64_t;
+
+    static constexpr tick_type never = std::numeric_limits< tick_type >::max();
+
+    /**
+     * @brief Adds a value due at the given tick
+     *
+     * @return false leaving value untouched if the tick is not after the current one
+     */
+    bool add( tick_type const due, T& value )
+    {
+        if ( due <= current_ )
+        {
+            return false;
+        }
+        place( entry{ due, std::move( value ) } );
+        ++size_;
+        return true;
+    }
+
+    /**
+     * @brief Moves the wheel forward to the given tick passing every value that became due to
+     * expired
+     */
+    template< typename Expired >
+    void advance( tick_type const now, Expired&& expired )
+    {
+        while ( current_ < now )
+        {
+            if ( size_ == 0U )
+            {
+                current_ = now;
+                return;
+            }
+            tick_type const next = next_tick();
+            current_             = next < now ? next : now;
+            if ( current_ != next )
+            {
+                return;
+            }
+            if ( ( current_ & ( ( tick_type{ 1 } << ( bits * levels ) ) - 1U ) ) == 0U )
+            {
+                std::vector< entry > overflow;
+                std::swap( overflow, overflow_ );
+                cascade( overflow, expired );
+            }
+            for ( unsigned level = levels - 1U; level > 0U; --level )
+            {
+                if ( ( current_ & ( ( tick_type{ 1 } << ( bits * level ) ) - 1U ) ) == 0U )
+                {
+                    std::vector< entry > cascaded;
+                    take( level, index( current_, level ), cascaded );
+                    cascade( cascaded, expired );
+                }
+            }
+            std::vector< entry > due;
+            take( 0U, index( current_, 0U ), due );
+            for ( entry& item : due )
+            {
+                --size_;
+                expired( std::move( item.value ) );
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the next tick the wheel has to be advanced to, where values are due or have
+     * to be cascaded, or never if it is empty
+     */
+    tick_type next_tick() const noexcept
+    {
+        for ( unsigned level = 0; level < levels; ++level )
+        {
+            unsigned const current = index( current_, level );
+            // slots past the current one, slots before it belong to the next block
+            std::uint64_t const later =
+                current + 1U < slots ? occupied_[level] & ( ~std::uint64_t{ 0 } << ( current + 1U ) )
+                                     : 0U;
+            if ( later != 0U )
+            {
+                unsigned const    slot  = first_bit( later );
+                unsigned const    shift = bits * ( level + 1U );
+                tick_type const   block = ( current_ >> shift ) << shift;
+                return block + ( tick_type{ slot } << ( bits * level ) );
+            }
+        }
+        if ( !overflow_.empty() )
+        {
+            unsigned const shift = bits * levels;
+            return ( ( current_ >> shift ) + 1U ) << shift;
+        }
+        return never;
+    }
+
+    tick_type   current() const noexcept { return current_; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    static constexpr unsigned bits   = 6;
+    static constexpr unsigned slots  = 1U << bits;
+    static constexpr unsigned levels = 4;
+
+    struct entry
+    {
+        tick_type due;
+        T         value;
+    };
+
+    static unsigned index( tick_type const tick, unsigned const level ) noexcept
+    {
+        return static_cast< unsigned >( tick >> ( bits * level ) ) & ( slots - 1U );
+    }
+
+    static unsigned first_bit( std::uint64_t const mask ) noexcept
+    {
+        unsigned bit = 0;
+        while ( ( mask & ( std::uint64_t{ 1 } << bit ) ) == 0U )
+        {
+            ++bit;
+        }
+        return bit;
+    }
+
+    void place( entry&& item )
+    {
+        for ( unsigned level = 0; level < levels; ++level )
+        {
+            unsigned const shift = bits * ( level + 1U );
+            if ( ( item.due >> shift ) == ( current_ >> shift ) )
+            {
+                unsigned const slot = index( item.due, level );
+                slots_[level][slot].push_back( std::move( item ) );
+                occupied_[level] |= std::uint64_t{ 1 } << slot;
+                return;
+            }
+        }
+        overflow_.push_back( std::move( item ) );
+    }
+
+    void take( unsigned const level, unsigned const slot, std::vector< entry >& out )
+    {
+        std::swap( out, slots_[level][slot] );
+        occupied_[level] &= ~( std::uint64_t{ 1 } << slot );
+    }
+
+    template< typename Expired >
+    void cascade( std::vector< entry >& items, Expired& expired )
+    {
+        for ( entry& item : items )
+        {
+            if ( item.due <= current_ )
+            {
+                --size_;
+                expired( std::move( item.value ) );
+            }
+            else
+            {
+                place( std::move( item ) );
+            }
+        }
+    }
+
+    tick_type current_ = 0;
+    std::size_t size_  = 0;
+    std::array< std::array< std::vector< entry >, slots >, levels > slots_{};
+    std::array< std::uint64_t, levels >                             occupied_{};
+    std::vector< entry >                                            overflow_;
+};
+
+template< typename T >
+constexpr typename timer_wheel< T >::tick_type timer_wheel< T >::never;
+} // namespace detail
+
+} // namespace be
@@ -7,19 +7,27 @@
 #include <memory>
 #include <task_pool/api.h>
 #include <task_pool/fallbacks.h>
+#include <task_pool/queues.h>
 #include <type_traits>
 #include <utility>
 
 namespace be {
 
-template <class Allocator> class task_pool_t;
+template <class Allocator, class ReadyQueue = locked_ready_queue>
+class task_pool_t;
+
+template <class Allocator, class ReadyQueue = locked_ready_queue>
+class task_group_t;
+
+template <class Pool> class schedule_awaiter;
 
 // template< template< typename, typename... > class Allocator, typename Value,
 // typename... Ts > class task_pool_t< Allocator< Value, Ts... > >;
 
 template <typename T> struct is_pool;
-template <template <typename> class T, class U>
-struct is_pool<T<U>> : public std::is_same<T<U>, be::task_pool_t<U>> {};
+template <template <typename, typename> class T, class U, class Q>
+struct is_pool<T<U, Q>>
+    : public std::is_same<T<U, Q>, be::task_pool_t<U, Q>> {};
 
 template <typename Func>
 static constexpr bool is_function_pointer_v =
@@ -161,6 +169,18 @@ struct is_allocator_constructible<
 template <typename T>
 static constexpr bool wants_allocator_v = wants_allocator<T>::value;
 
+/**
+ * @brief Type erased callback registered on future-like objects that can notify when they become
+ * ready
+ */
+struct continuation {
+  void (*function)(void *) = nullptr;
+  void *context = nullptr;
+
+  explicit operator bool() const noexcept { return function != nullptr; }
+  void operator()() const { function(context); }
+};
+
 namespace future_api {
 template <typename Future>
 using get_result_t = decltype(std::declval<Future>().get());
@@ -194,6 +214,16 @@ struct is_supported<T, be_void_t<get_result_t<T>, wait_result_t<T>,
                            is_future_status<wait_until_result_t<T>>::value,
                        std::true_type, std::false_type>::type {};
 
+template <typename Future>
+using set_continuation_t = decltype(std::declval<Future &>().set_continuation(
+    std::declval<continuation const &>()));
+
+template <typename T, typename = void> struct is_notifying : std::false_type {};
+
+template <typename T>
+struct is_notifying<T, be_void_t<set_continuation_t<T>>>
+    : std::is_same<bool, set_continuation_t<T>> {};
+
 } // namespace future_api
 
 template <typename T> struct is_future : future_api::is_supported<T>::type {};
@@ -263,11 +293,37 @@ auto wrap_future_argument(T &&t) {
     T value;
     T operator()() { return std::forward<T>(value); }
     static bool is_ready() { return true; }
+    static constexpr bool notifies() { return true; }
+    static bool set_continuation(continuation const & /*next*/) { return false; }
+  };
+  return func_{std::forward<T>(t)};
+}
+
+template <typename T,
+          std::enable_if_t<be::is_future<T>::value &&
+                               !future_api::is_notifying<T>::value,
+                           bool> = true>
+auto wrap_future_argument(T &&t) {
+  using status_type = decltype(std::declval<T>().wait_for(
+      std::declval<std::chrono::seconds>()));
+  static_assert(future_api::is_future_status<status_type>::value,
+                "T::wait_for does not return a future_status-like enum");
+  struct func_ {
+    T value;
+    be::future_value_t<T> operator()() { return value.get(); }
+    bool is_ready() const {
+      return value.wait_for(std::chrono::seconds(0)) == status_type::ready;
+    }
+    static constexpr bool notifies() { return false; }
+    static bool set_continuation(continuation const & /*next*/) { return false; }
   };
   return func_{std::forward<T>(t)};
 }
 
-template <typename T, std::enable_if_t<be::is_future<T>::value, bool> = true>
+template <typename T,
+          std::enable_if_t<be::is_future<T>::value &&
+                               future_api::is_notifying<T>::value,
+                           bool> = true>
 auto wrap_future_argument(T &&t) {
   using status_type = decltype(std::declval<T>().wait_for(
       std::declval<std::chrono::seconds>()));
@@ -279,6 +335,10 @@ auto wrap_future_argument(T &&t) {
     bool is_ready() const {
       return value.wait_for(std::chrono::seconds(0)) == status_type::ready;
     }
+    static constexpr bool notifies() { return true; }
+    bool set_continuation(continuation const &next) {
+      return value.set_continuation(next);
+    }
   };
   return func_{std::forward<T>(t)};
 }
@@ -342,13 +402,58 @@ void invoke_deferred_task(Promise &promise, Callable callable,
   promise.set_value(callable(std::get<Is>(arguments)()...));
 }
 
+template <typename Arguments>
+bool check_argument_status(Arguments & /*arguments*/, std::size_t & /*ready*/,
+                           std::index_sequence<> /*Is*/) {
+  return true;
+}
+
+/**
+ * @brief Checks the wrapped arguments in order from the first one not known to be ready, stopping
+ * at the first that is not. ready counts the leading arguments found ready so far, arguments stay
+ * ready once they are so none is checked again after it was found ready.
+ */
+template <typename Arguments, std::size_t I, std::size_t... Is>
+bool check_argument_status(Arguments &arguments, std::size_t &ready,
+                           std::index_sequence<I, Is...> /*Is*/) {
+  if (ready <= I) {
+    if (!std::get<I>(arguments).is_ready()) {
+      return false;
+    }
+    ready = I + 1U;
+  }
+  return check_argument_status(arguments, ready, std::index_sequence<Is...>{});
+}
+
+/**
+ * @brief True if every wrapped argument can notify a continuation when it becomes ready
+ */
 template <typename Arguments, std::size_t... Is>
-bool check_argument_status(Arguments &arguments,
-                           std::index_sequence<Is...> /*Is*/) {
-  std::array<bool, sizeof...(Is)> args_status{
-      std::get<Is>(arguments).is_ready()...};
-  return std::all_of(args_status.begin(), args_status.end(),
-                     [](auto value) { return value; });
+constexpr bool arguments_notify(std::index_sequence<Is...> /*Is*/) {
+  std::array<bool, sizeof...(Is)> notifies{
+      std::tuple_element_t<Is, Arguments>::notifies()...};
+  for (bool value : notifies) {
+    if (!value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Registers next on every wrapped argument invoking it directly for each argument that is
+ * ready already such that next is invoked exactly once per argument
+ */
+template <typename Arguments, std::size_t... Is>
+void subscribe_arguments(Arguments &arguments, continuation const &next,
+                         std::index_sequence<Is...> /*Is*/) {
+  std::array<bool, sizeof...(Is)> registered{
+      std::get<Is>(arguments).set_continuation(next)...};
+  for (bool value : registered) {
+    if (!value) {
+      next();
+    }
+  }
 }
 
 namespace pipe_api {
@@ -1,11 +1,420 @@
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <task_pool/futures.h>
 #include <task_pool/pool.h>
 
+#if defined( __linux__ )
+#    include <climits>
+#    include <ctime>
+#    include <dirent.h>
+#    include <fstream>
+#    include <linux/futex.h>
+#    include <pthread.h>
+#    include <sched.h>
+#    include <sys/resource.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#else
+#    include <thread>
+#    include <array>
+#    include <condition_variable>
+#    include <cstddef>
+#    include <functional>
+#    include <mutex>
+#endif
+
 namespace be {
 
-TASKPOOL_API stop_token::operator bool()
+namespace detail {
+TASKPOOL_API bool stop_state::request_stop()
+{
+    std::unique_lock< std::mutex > lock( mutex_ );
+    if ( stopped_ )
+    {
+        return false;
+    }
+    stopped_ = true;
+    runner_  = std::this_thread::get_id();
+    while ( !callbacks_.empty() )
+    {
+        stop_callback_node* callback = callbacks_.front();
+        callbacks_.pop_front();
+        running_ = callback;
+        lock.unlock();
+        callback->run();
+        lock.lock();
+        running_ = nullptr;
+        callback_done_.notify_all();
+    }
+    return true;
+}
+
+TASKPOOL_API bool stop_state::add( stop_callback_node* callback )
+{
+    std::unique_lock< std::mutex > lock( mutex_ );
+    if ( stopped_ )
+    {
+        return false;
+    }
+    callbacks_.push_back( callback );
+    return true;
+}
+
+TASKPOOL_API void stop_state::remove( stop_callback_node* callback )
+{
+    std::unique_lock< std::mutex > lock( mutex_ );
+    auto const position = std::find( callbacks_.begin(), callbacks_.end(), callback );
+    if ( position != callbacks_.end() )
+    {
+        callbacks_.erase( position );
+        return;
+    }
+    // a callback may destroy its own stop_callback, only other threads wait for it
+    if ( running_ == callback && runner_ != std::this_thread::get_id() )
+    {
+        callback_done_.wait( lock, [this, callback] { return running_ != callback; } );
+    }
+}
+} // namespace detail
+
+TASKPOOL_API numa_topology read_numa_topology( std::string const& root )
+{
+    numa_topology topology;
+#if defined( __linux__ )
+    std::unique_ptr< DIR, int ( * )( DIR* ) > directory( opendir( root.c_str() ), &closedir );
+    if ( !directory )
+    {
+        return topology;
+    }
+    while ( dirent const* entry = readdir( directory.get() ) )
+    {
+        std::string const name = entry->d_name;
+        if ( name.size() < 5U || name.compare( 0, 4, "node" ) != 0 ||
+             name.find_first_not_of( "0123456789", 4 ) != std::string::npos )
+        {
+            continue;
+        }
+        std::ifstream file( root + "/" + name + "/cpulist" );
+        std::string   list;
+        std::getline( file, list );
+        numa_node node;
+        node.id   = static_cast< unsigned >( std::strtoul( name.c_str() + 4, nullptr, 10 ) );
+        node.cpus = detail::parse_cpu_list( list );
+        if ( !node.cpus.empty() )
+        {
+            topology.push_back( std::move( node ) );
+        }
+    }
+    std::sort( topology.begin(), topology.end(), []( numa_node const& lhs, numa_node const& rhs ) {
+        return lhs.id < rhs.id;
+    } );
+#else
+    static_cast< void >( root );
+#endif
+    return topology;
+}
+
+namespace detail {
+
+TASKPOOL_API std::vector< unsigned > parse_cpu_list( std::string const& list )
+{
+    constexpr unsigned long max_cpu = 1UL << 16U; // guards against ranges that never end
+    std::vector< unsigned > cpus;
+    std::istringstream      stream( list );
+    std::string             range;
+    while ( std::getline( stream, range, ',' ) )
+    {
+        char*               end   = nullptr;
+        unsigned long const first = std::strtoul( range.c_str(), &end, 10 );
+        if ( end == range.c_str() )
+        {
+            continue;
+        }
+        unsigned long last = first;
+        if ( *end == '-' )
+        {
+            char const* const start = end + 1;
+            last                    = std::strtoul( start, &end, 10 );
+            if ( end == start || last < first )
+            {
+                continue;
+            }
+        }
+        if ( last >= max_cpu )
+        {
+            continue;
+        }
+        for ( unsigned long cpu = first; cpu <= last; ++cpu )
+        {
+            cpus.push_back( static_cast< unsigned >( cpu ) );
+        }
+    }
+    return cpus;
+}
+
+#if defined( __linux__ )
+
+struct worker_thread::handle
+{
+    pthread_t               thread{};
+    std::function< void() > entry;
+
+    static void* run( void* x )
+    {
+        static_cast< handle* >( x )->entry();
+        return nullptr;
+    }
+};
+
+worker_thread::worker_thread( std::size_t const stack_size, std::function< void() > entry )
+    : handle_( std::make_unique< handle >() )
+{
+    handle_->entry = std::move( entry );
+    pthread_attr_t attributes;
+    pthread_attr_init( &attributes );
+    if ( stack_size != 0U )
+    {
+        pthread_attr_setstacksize( &attributes,
+                                   std::max< std::size_t >( stack_size, PTHREAD_STACK_MIN ) );
+    }
+    int const result = pthread_create( &handle_->thread, &attributes, &handle::run, handle_.get() );
+    pthread_attr_destroy( &attributes );
+    if ( result != 0 )
+    {
+        handle_.reset();
+        throw std::system_error( result, std::generic_category(), "pthread_create" );
+    }
+}
+
+void worker_thread::join()
+{
+    pthread_join( handle_->thread, nullptr );
+    handle_.reset();
+}
+
+TASKPOOL_API void configure_thread( thread_options const& options, unsigned const index )
+{
+    if ( !options.name_prefix.empty() )
+    {
+        std::string const name = ( options.name_prefix + std::to_string( index ) ).substr( 0, 15 );
+        pthread_setname_np( pthread_self(), name.c_str() );
+    }
+    if ( !options.cpu_sets.empty() )
+    {
+        pin_current_thread( options.cpu_sets[index % options.cpu_sets.size()] );
+    }
+    if ( options.policy != thread_policy::inherit )
+    {
+        int         policy = SCHED_OTHER;
+        sched_param parameters{};
+        switch ( options.policy )
+        {
+        case thread_policy::batch:
+            policy = SCHED_BATCH;
+            break;
+        case thread_policy::idle:
+            policy = SCHED_IDLE;
+            break;
+        case thread_policy::fifo:
+            policy                    = SCHED_FIFO;
+            parameters.sched_priority = options.priority;
+            break;
+        case thread_policy::round_robin:
+            policy                    = SCHED_RR;
+            parameters.sched_priority = options.priority;
+            break;
+        default:
+            break;
+        }
+        pthread_setschedparam( pthread_self(), policy, &parameters );
+    }
+    if ( options.nice != 0 )
+    {
+        auto const thread = static_cast< id_t >( syscall( SYS_gettid ) ); // NOLINT
+        setpriority( PRIO_PROCESS, thread, options.nice );
+    }
+}
+
+TASKPOOL_API bool pin_current_thread( std::vector< unsigned > const& cpus ) noexcept
+{
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    bool any = false;
+    for ( unsigned const cpu : cpus )
+    {
+        if ( cpu < CPU_SETSIZE )
+        {
+            CPU_SET( cpu, &set );
+            any = true;
+        }
+    }
+    return any && pthread_setaffinity_np( pthread_self(), sizeof( set ), &set ) == 0;
+}
+
+TASKPOOL_API int current_cpu() noexcept
+{
+    return sched_getcpu();
+}
+
+#else
+
+struct worker_thread::handle
+{
+    std::thread thread;
+};
+
+worker_thread::worker_thread( std::size_t const /*stack_size*/, std::function< void() > entry )
+    : handle_( std::make_unique< handle >() )
+{
+    handle_->thread = std::thread( std::move( entry ) );
+}
+
+void worker_thread::join()
+{
+    handle_->thread.join();
+    handle_.reset();
+}
+
+TASKPOOL_API void configure_thread( thread_options const& /*options*/, unsigned const /*index*/ )
+{
+}
+
+TASKPOOL_API bool pin_current_thread( std::vector< unsigned > const& /*cpus*/ ) noexcept
+{
+    return false;
+}
+
+TASKPOOL_API int current_cpu() noexcept
+{
+    return -1;
+}
+
+#endif
+
+worker_thread::worker_thread() noexcept = default;
+
+worker_thread::worker_thread( worker_thread&& other ) noexcept = default;
+
+worker_thread& worker_thread::operator=( worker_thread&& other ) noexcept
+{
+    if ( joinable() )
+    {
+        join();
+    }
+    handle_ = std::move( other.handle_ );
+    return *this;
+}
+
+worker_thread::~worker_thread()
+{
+    if ( joinable() )
+    {
+        join();
+    }
+}
+
+TASKPOOL_API task_helper& this_thread_helper() noexcept
+{
+    static thread_local task_helper s_helper;
+    return s_helper;
+}
+
+static_assert( sizeof( std::atomic< std::uint32_t > ) == sizeof( std::uint32_t ),
+               "atomic_wait requires atomic words without extra state" );
+
+#if defined( __linux__ )
+
+namespace {
+long futex( std::atomic< std::uint32_t >& word, int op, std::uint32_t value, timespec* timeout )
+{
+    return syscall( SYS_futex, // NOLINT
+                    reinterpret_cast< std::uint32_t* >( &word ), // NOLINT
+                    op,
+                    value,
+                    timeout,
+                    nullptr,
+                    0 );
+}
+} // namespace
+
+TASKPOOL_API void atomic_wait( std::atomic< std::uint32_t >& word, std::uint32_t expected )
 {
-    return token.load();
+    futex( word, FUTEX_WAIT_PRIVATE, expected, nullptr );
 }
 
+TASKPOOL_API void atomic_wait_for( std::atomic< std::uint32_t >& word,
+                                   std::uint32_t                 expected,
+                                   std::chrono::nanoseconds      timeout )
+{
+    using namespace std::chrono;
+    if ( timeout <= nanoseconds::zero() )
+    {
+        return;
+    }
+    auto const whole = duration_cast< seconds >( timeout );
+    timespec   relative{};
+    relative.tv_sec  = static_cast< time_t >( whole.count() );
+    relative.tv_nsec = static_cast< long >( ( timeout - whole ).count() );
+    futex( word, FUTEX_WAIT_PRIVATE, expected, &relative );
+}
+
+TASKPOOL_API void atomic_notify_all( std::atomic< std::uint32_t >& word )
+{
+    futex( word, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr );
+}
+
+#else
+
+namespace {
+struct wait_bucket
+{
+    std::mutex              mutex_;
+    std::condition_variable changed_;
+};
+
+wait_bucket& bucket_for( std::atomic< std::uint32_t > const& word )
+{
+    static std::array< wait_bucket, 64 > s_buckets;
+    auto const index = std::hash< void const* >{}( &word ) % s_buckets.size();
+    return s_buckets[ index ];
+}
+} // namespace
+
+TASKPOOL_API void atomic_wait( std::atomic< std::uint32_t >& word, std::uint32_t expected )
+{
+    wait_bucket&                   bucket = bucket_for( word );
+    std::unique_lock< std::mutex > lock( bucket.mutex_ );
+    if ( word.load() == expected )
+    {
+        bucket.changed_.wait( lock );
+    }
+}
+
+TASKPOOL_API void atomic_wait_for( std::atomic< std::uint32_t >& word,
+                                   std::uint32_t                 expected,
+                                   std::chrono::nanoseconds      timeout )
+{
+    wait_bucket&                   bucket = bucket_for( word );
+    std::unique_lock< std::mutex > lock( bucket.mutex_ );
+    if ( word.load() == expected )
+    {
+        bucket.changed_.wait_for( lock, timeout );
+    }
+}
+
+TASKPOOL_API void atomic_notify_all( std::atomic< std::uint32_t >& word )
+{
+    wait_bucket&                   bucket = bucket_for( word );
+    std::unique_lock< std::mutex > lock( bucket.mutex_ );
+    bucket.changed_.notify_all();
+}
+
+#endif
+
+} // namespace detail
+
 template class task_pool_t< std::allocator< void > >;
 } // namespace be
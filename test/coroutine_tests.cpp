@@ -0,0 +1,182 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <task_pool/coroutine.h>
+#include <task_pool/futures.h>
+#include <task_pool/pool.h>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+struct counts
+{
+    std::atomic_uint64_t allocations{ 0 };
+    std::atomic_uint64_t deallocations{ 0 };
+};
+
+template< class T >
+struct counting_allocator
+{
+    counts* counter = nullptr;
+
+    using value_type = T;
+
+    explicit counting_allocator( counts& amounts ) noexcept
+        : counter( &amounts )
+    {
+    }
+    template< class U >
+    explicit counting_allocator( const counting_allocator< U >& other ) noexcept
+        : counter( other.counter )
+    {
+    }
+
+    T* allocate( std::size_t n )
+    {
+        ++( *counter ).allocations;
+        return std::allocator< T >().allocate( n );
+    }
+    void deallocate( T* p, std::size_t n ) const
+    {
+        ++( *counter ).deallocations;
+        std::allocator< T >().deallocate( p, n );
+    }
+};
+
+template< class T, class U >
+constexpr bool operator==( const counting_allocator< T >& /*T*/,
+                           const counting_allocator< U >& /*U*/ ) noexcept
+{
+    return true;
+}
+
+template< class T, class U >
+constexpr bool operator!=( const counting_allocator< T >& /*T*/,
+                           const counting_allocator< U >& /*U*/ ) noexcept
+{
+    return false;
+}
+
+be::task< std::thread::id > thread_of( be::task_pool& pool )
+{
+    co_await pool.schedule();
+    co_return std::this_thread::get_id();
+}
+
+be::task< int > fibonacci( be::task_pool& pool, int n )
+{
+    if ( n < 2 )
+    {
+        co_return n;
+    }
+    auto lhs = fibonacci( pool, n - 1 );
+    auto rhs = fibonacci( pool, n - 2 );
+    co_return co_await lhs + co_await rhs;
+}
+
+be::task<> fail( be::task_pool& pool )
+{
+    co_await pool.schedule();
+    throw std::runtime_error( "failed" );
+}
+
+be::task< int > one( be::task_pool_t< counting_allocator< char > >& pool )
+{
+    co_await pool.schedule();
+    co_return 1;
+}
+
+be::task< int > add_one( be::task_pool& /*pool*/, be::future< int > input )
+{
+    co_return co_await input + 1;
+}
+} // namespace
+
+TEST_CASE( "coroutine/schedule", "[coroutine]" )
+{
+    be::task_pool pool( 2 );
+    auto          id = be::spawn( pool, thread_of( pool ) );
+    REQUIRE( id.get() != std::this_thread::get_id() );
+}
+
+TEST_CASE( "coroutine/nested tasks", "[coroutine]" )
+{
+    be::task_pool pool( 2 );
+    REQUIRE( be::spawn( pool, fibonacci( pool, 16 ) ).get() == 987 );
+    auto failed = be::spawn( pool, fail( pool ) );
+    REQUIRE_THROWS_AS( failed.get(), std::runtime_error );
+}
+
+TEST_CASE( "coroutine/await futures", "[coroutine]" )
+{
+    be::task_pool         pool( 1 );
+    be::promise< int >    input;
+    auto                  result = be::spawn( pool, add_one( pool, input.get_future() ) );
+    std::this_thread::sleep_for( 1ms );
+    // the coroutine is suspended on the future, not blocking the only thread of the pool
+    auto other = pool.submit< be::promise >( std::launch::async, [] { return 2; } );
+    REQUIRE( other.get() == 2 );
+    input.set_value( 41 );
+    REQUIRE( result.get() == 42 );
+
+    auto submitted = [&pool]() -> be::task< int > {
+        co_await pool.schedule();
+        co_return co_await pool.submit< be::promise >( std::launch::async, [] { return 7; } );
+    };
+    REQUIRE( be::spawn( pool, submitted() ).get() == 7 );
+}
+
+TEST_CASE( "coroutine/frame allocator", "[coroutine][allocator]" )
+{
+    counts amounts;
+    {
+        be::task_pool_t< counting_allocator< char > > pool( 1,
+                                                            counting_allocator< char >( amounts ) );
+        auto const before = amounts.allocations.load();
+        REQUIRE( be::spawn( pool, one( pool ) ).get() == 1 );
+        REQUIRE( amounts.allocations - before >= 2U ); // the task and the coroutine running it
+    }
+    REQUIRE( amounts.allocations == amounts.deallocations );
+}
+
+TEST_CASE( "coroutine/cancelled schedule", "[coroutine][stop_token]" )
+{
+    be::task_pool   pool( 1 );
+    be::stop_source source;
+    source.request_stop();
+    auto work = [&pool]( be::stop_token token ) -> be::task< int > {
+        co_await pool.schedule( { std::launch::async, token } );
+        co_return 1;
+    };
+    REQUIRE_THROWS_AS( be::spawn( pool, work( source.get_token() ) ).get(), be::task_cancelled );
+}
+
+TEST_CASE( "coroutine/abort queued spawn", "[coroutine][abort]" )
+{
+    counts amounts;
+    {
+        be::task_pool_t< counting_allocator< char > > pool( 1,
+                                                            counting_allocator< char >( amounts ) );
+        pool.pause();
+        auto queued = be::spawn( pool, one( pool ) );
+        pool.abort();
+        REQUIRE_THROWS_AS( queued.get(), std::future_error );
+    }
+    REQUIRE( amounts.allocations == amounts.deallocations );
+
+    be::task_pool      pool( 1 );
+    be::promise< int > input;
+    auto               result = be::spawn( pool, add_one( pool, input.get_future() ) );
+    std::this_thread::sleep_for( 1ms );
+    // the task awaiting the future is queued and destroyed with the coroutine spawning it
+    pool.pause();
+    input.set_value( 41 );
+    pool.abort();
+    REQUIRE_THROWS_AS( result.get(), std::future_error );
+}
@@ -1,22 +1,43 @@
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <catch2/catch.hpp>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <exception>
+#include <functional>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <task_pool/algorithms.h>
+#include <task_pool/group.h>
 #include <task_pool/pipes.h>
 #include <task_pool/pool.h>
 #include <task_pool/traits.h>
 #include <thread>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined( __linux__ )
+#    include <pthread.h>
+#    include <sched.h>
+#    include <sys/resource.h>
+#    include <sys/stat.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
 using namespace std::chrono_literals;
 
 struct test_exception : public std::exception
@@ -545,6 +566,25 @@ TEST_CASE( "submit with result allocator", "[task_pool][submit][allocator]" )
     CHECK( amounts.constructions > 0 );
 }
 
+TEST_CASE( "small tasks are stored inline", "[task_pool][submit][allocator]" )
+{
+    counts                    amounts;
+    counting_allocator< int > alloc( amounts );
+    std::array< char, 512 >   large{};
+    {
+        be::notifying_promise< void > promise( std::allocator_arg_t{}, alloc );
+    }
+    auto const per_promise = amounts.allocations.load();
+    amounts.allocations    = 0;
+    {
+        be::task_pool_t< counting_allocator< int > > pool( 1, alloc );
+        pool.submit( std::launch::async, []() {} ).wait();
+        CHECK( amounts.allocations == per_promise );
+        pool.submit( std::launch::async, [large]() { return large[0]; } ).wait();
+        CHECK( amounts.allocations == 2 * per_promise + 1 );
+    }
+}
+
 void fun_with_token( be::stop_token /*unused*/ );
 
 TEST_CASE( "wants_stop_token", "[task_pool][submit][stop_token]" )
@@ -2087,6 +2127,21 @@ TEST_CASE( "pipe with stop_token", "[pipe][stop_token]" )
     REQUIRE( called );
 }
 
+TEST_CASE( "pipe with stop_source", "[pipe][stop_token]" )
+{
+    be::task_pool    pool( 1 );
+    be::stop_source  source;
+    std::atomic_bool called{ false };
+    pool.pause();
+    be::task_options const options( std::launch::async, source.get_token() );
+    auto pipe = be::make_pipe( pool, options, [] { return 1; } ) |
+                [&]( int /*value*/ ) { called = true; };
+    source.request_stop();
+    pool.unpause();
+    REQUIRE_THROWS_AS( pipe.get(), be::task_cancelled );
+    REQUIRE_FALSE( called );
+}
+
 TEST_CASE( "pipe with allocator", "[pipe][allocator]" )
 {
     be::task_pool pool;
@@ -2336,4 +2391,1996 @@ TEST_CASE( "Execute in main with dependencies", "[std::launch::deferred]" )
     pool.wait_for( s_timeout );
     pool.invoke_deferred();
     REQUIRE( called.load() );
-}
\ No newline at end of file
+}
+
+TEST_CASE( "check_argument_status", "[traits]" )
+{
+    struct counted_argument
+    {
+        bool const* ready;
+        int*        checks;
+        bool        is_ready() const
+        {
+            ++*checks;
+            return *ready;
+        }
+    };
+    std::array< bool, 2 > ready{ { false, false } };
+    std::array< int, 2 >  checks{ { 0, 0 } };
+    std::size_t           known    = 0;
+    auto const            sequence = std::make_index_sequence< 2 >{};
+    std::tuple< counted_argument, counted_argument > const arguments{ { &ready[0], &checks[0] },
+                                                                      { &ready[1], &checks[1] } };
+
+    // arguments after the first that is not ready are not checked
+    REQUIRE_FALSE( be::check_argument_status( arguments, known, sequence ) );
+    REQUIRE( checks[0] == 1 );
+    REQUIRE( checks[1] == 0 );
+
+    ready[0] = true;
+    REQUIRE_FALSE( be::check_argument_status( arguments, known, sequence ) );
+    REQUIRE( known == 1U );
+
+    // nor are arguments found ready before
+    ready[1] = true;
+    REQUIRE( be::check_argument_status( arguments, known, sequence ) );
+    REQUIRE( checks[0] == 2 );
+    REQUIRE( checks[1] == 2 );
+    REQUIRE( known == 2U );
+}
+
+TEST_CASE( "lazy arguments/check batch", "[task_pool]" )
+{
+    be::pool_options options;
+    options.thread_count = 1;
+    options.check_batch  = 2;
+    be::task_pool pool( options );
+
+    std::vector< std::promise< int > > inputs( 9 );
+    std::vector< std::future< int > >  results;
+    for ( auto& input : inputs )
+    {
+        results.push_back( pool.submit(
+            std::launch::async, []( int x ) { return x * 2; }, input.get_future() ) );
+    }
+    REQUIRE( pool.get_tasks_waiting() == inputs.size() );
+    for ( std::size_t i = inputs.size(); i-- > 0U; )
+    {
+        inputs[i].set_value( static_cast< int >( i ) );
+    }
+    for ( std::size_t i = 0; i < results.size(); ++i )
+    {
+        REQUIRE( results[i].get() == static_cast< int >( i ) * 2 );
+    }
+    REQUIRE( pool.get_tasks_waiting() == 0U );
+}
+
+TEST_CASE( "lazy arguments/sharded checks", "[task_pool]" )
+{
+    be::pool_options options;
+    options.thread_count = 4;
+    options.check_batch  = 16;
+    be::task_pool pool( options );
+
+    // tasks spread over the shards of all threads, each checked by whichever thread gets to it
+    std::vector< std::promise< int > > inputs( 500 );
+    std::vector< std::future< int > >  results;
+    for ( auto& input : inputs )
+    {
+        results.push_back( pool.submit(
+            std::launch::async, []( int x ) { return x + 1; }, input.get_future() ) );
+    }
+    auto const stats = pool.stats();
+    REQUIRE( stats.total().tasks_polled == inputs.size() );
+    for ( auto const& worker : stats.workers )
+    {
+        REQUIRE( worker.tasks_polled >= inputs.size() / stats.workers.size() );
+    }
+    std::thread producer( [&inputs] {
+        for ( std::size_t i = 0; i < inputs.size(); ++i )
+        {
+            inputs[i].set_value( static_cast< int >( i ) );
+        }
+    } );
+    for ( std::size_t i = 0; i < results.size(); ++i )
+    {
+        REQUIRE( results[i].get() == static_cast< int >( i ) + 1 );
+    }
+    producer.join();
+    REQUIRE( pool.get_tasks_waiting() == 0U );
+}
+
+TEST_CASE( "construction/options", "[task_pool]" )
+{
+    be::pool_options options;
+    options.thread_count  = 2;
+    options.check_latency = std::chrono::microseconds( 10 );
+    options.scheduling    = be::schedule_policy::work_stealing;
+    be::task_pool pool( options );
+    REQUIRE( pool.get_thread_count() == 2 );
+    REQUIRE( pool.get_check_latency() == std::chrono::microseconds( 10 ) );
+    REQUIRE( pool.get_schedule_policy() == be::schedule_policy::work_stealing );
+    pool.reset( 3 );
+    REQUIRE( pool.get_thread_count() == 3 );
+    REQUIRE( pool.get_schedule_policy() == be::schedule_policy::work_stealing );
+    pool.abort();
+    REQUIRE( pool.get_thread_count() == 3 );
+    REQUIRE( pool.get_schedule_policy() == be::schedule_policy::work_stealing );
+}
+
+TEST_CASE( "work stealing/submit", "[task_pool][work_stealing]" )
+{
+    be::pool_options options;
+    options.scheduling = be::schedule_policy::work_stealing;
+    be::task_pool                     pool( options );
+    static const int                  s_count = 1'000;
+    std::vector< std::future< int > > results;
+    for ( int i = 0; i < s_count; ++i )
+    {
+        results.push_back( pool.submit( std::launch::async, []( int x ) { return x * 2; }, i ) );
+    }
+    pool.wait();
+    for ( int i = 0; i < s_count; ++i )
+    {
+        REQUIRE( results[static_cast< std::size_t >( i )].get() == i * 2 );
+    }
+}
+
+TEST_CASE( "work stealing/nested submit", "[task_pool][work_stealing]" )
+{
+    be::pool_options options;
+    options.thread_count = 4;
+    options.scheduling   = be::schedule_policy::work_stealing;
+    be::task_pool            pool( options );
+    static const std::size_t s_count = 100;
+    std::atomic_size_t       counter{ 0 };
+    auto                     spawn = [&]() {
+        for ( std::size_t i = 0; i < s_count; ++i )
+        {
+            pool.submit( std::launch::async, [&]() { ++counter; } );
+        }
+    };
+    for ( std::size_t i = 0; i < s_count; ++i )
+    {
+        pool.submit( std::launch::async, spawn );
+    }
+    pool.wait();
+    REQUIRE( counter == s_count * s_count );
+    REQUIRE( pool.get_tasks_total() == 0 );
+}
+
+TEST_CASE( "work stealing/get_tasks_queued", "[task_pool][work_stealing]" )
+{
+    be::pool_options options;
+    options.thread_count = 2;
+    options.scheduling   = be::schedule_policy::work_stealing;
+    be::task_pool    pool( options );
+    std::atomic_bool finish{ false };
+    pool.pause();
+    auto future = pool.submit( std::launch::async, [&]() {
+        while ( !finish )
+        {
+            std::this_thread::sleep_for( 1ms );
+        }
+    } );
+    REQUIRE( pool.get_tasks_queued() == 1 );
+    pool.unpause();
+    finish = true;
+    pool.wait();
+    REQUIRE( pool.get_tasks_queued() == 0 );
+    REQUIRE( pool.get_tasks_running() == 0 );
+}
+
+TEST_CASE( "work stealing/task counts", "[task_pool][work_stealing]" )
+{
+    be::pool_options options;
+    options.thread_count = 4;
+    options.scheduling   = be::schedule_policy::work_stealing;
+    be::task_pool                      pool( options );
+    std::atomic_bool                   finish{ false };
+    std::atomic_int                    started{ 0 };
+    std::vector< std::future< void > > children;
+    auto                               parent = pool.submit( std::launch::async, [&]() {
+        // queued on the deque of this thread, the others have to steal them
+        for ( int i = 0; i < 3; ++i )
+        {
+            children.push_back( pool.submit( std::launch::async, [&]() {
+                ++started;
+                while ( !finish )
+                {
+                    std::this_thread::sleep_for( 1ms );
+                }
+            } ) );
+        }
+    } );
+    parent.get();
+    // the parent may still be counted for a moment after its future became ready
+    while ( started != 3 || pool.get_tasks_running() > 3 )
+    {
+        std::this_thread::sleep_for( 1ms );
+    }
+    REQUIRE( pool.get_tasks_queued() == 0 );
+    REQUIRE( pool.get_tasks_running() == 3 );
+    REQUIRE( pool.get_tasks_total() == 3 );
+    finish = true;
+    pool.wait();
+    REQUIRE( pool.get_tasks_running() == 0 );
+    REQUIRE( pool.get_tasks_total() == 0 );
+}
+
+TEST_CASE( "work stealing/lazy arguments", "[task_pool][work_stealing]" )
+{
+    be::pool_options options;
+    options.scheduling = be::schedule_policy::work_stealing;
+    be::task_pool pool( options );
+    auto          pipe = pool | []() { return 20; } | []( int x ) { return x + 1; } |
+                []( int x ) { return x * 2; };
+    REQUIRE( pipe.get() == 42 );
+}
+
+TEST_CASE( "is_notifying", "[traits]" )
+{
+    STATIC_REQUIRE( be::future_api::is_notifying< be::notifying_future< int > >::value );
+    STATIC_REQUIRE( be::future_api::is_notifying< be::notifying_future< void > >::value );
+    STATIC_REQUIRE_FALSE( be::future_api::is_notifying< std::future< int > >::value );
+    STATIC_REQUIRE( be::is_future< be::notifying_future< int > >::value );
+    STATIC_REQUIRE( be::is_promise_v< be::notifying_promise > );
+}
+
+TEST_CASE( "notifying_promise continuation", "[promises]" )
+{
+    std::atomic_int              calls{ 0 };
+    auto                         count = []( void* x ) { ++( *static_cast< std::atomic_int* >( x ) ); };
+    be::continuation const       next{ count, &calls };
+    be::notifying_promise< int > promise;
+    be::notifying_future< int >  future = promise.get_future();
+    REQUIRE( future.set_continuation( next ) );
+    REQUIRE( calls == 0 );
+    promise.set_value( 42 );
+    REQUIRE( calls == 1 );
+    REQUIRE_FALSE( future.set_continuation( next ) );
+    REQUIRE( future.get() == 42 );
+}
+
+TEST_CASE( "notifying_promise broken promise", "[promises]" )
+{
+    std::atomic_int              calls{ 0 };
+    be::notifying_future< void > future;
+    {
+        be::notifying_promise< void > promise;
+        future = promise.get_future();
+        REQUIRE( future.set_continuation(
+            { []( void* x ) { ++( *static_cast< std::atomic_int* >( x ) ); }, &calls } ) );
+    }
+    REQUIRE( calls == 1 );
+    REQUIRE_THROWS_AS( future.get(), std::future_error );
+}
+
+TEST_CASE( "submit( notifying future ) is parked", "[task_pool][submit][promises]" )
+{
+    std::atomic_bool finish{ false };
+    be::task_pool    pool( 2 );
+    auto             value = pool.submit< be::notifying_promise >( std::launch::async, [&]() {
+        while ( !finish )
+        {
+            std::this_thread::sleep_for( 1ms );
+        }
+        return 41;
+    } );
+    auto result = pool.submit( std::launch::async, []( int x ) { return x + 1; }, std::move( value ) );
+    REQUIRE( pool.get_tasks_waiting() == 1 );
+    finish = true;
+    REQUIRE( result.get() == 42 );
+    pool.wait();
+    REQUIRE( pool.get_tasks_waiting() == 0 );
+}
+
+TEST_CASE( "submit( submit ) is parked by default", "[task_pool][submit][promises]" )
+{
+    std::atomic_bool finish{ false };
+    be::task_pool    pool( 2 );
+    auto             value = pool.submit( std::launch::async, [&]() {
+        while ( !finish )
+        {
+            std::this_thread::sleep_for( 1ms );
+        }
+        return 41;
+    } );
+    STATIC_REQUIRE( std::is_base_of< std::future< int >, decltype( value ) >::value );
+    auto result = pool.submit( std::launch::async, []( int x ) { return x + 1; }, std::move( value ) );
+    REQUIRE( pool.get_tasks_waiting() == 1 );
+    REQUIRE( pool.stats().total().tasks_polled == 0 );
+    finish = true;
+    REQUIRE( result.get() == 42 );
+
+    // results may still be stored as std::future
+    std::future< int > plain = pool.submit( std::launch::async, []() { return 1; } );
+    REQUIRE( plain.get() == 1 );
+}
+
+TEST_CASE( "submit( notifying future ) throws", "[task_pool][submit][promises][throws]" )
+{
+    be::task_pool pool;
+    auto          value = pool.submit< be::notifying_promise >( std::launch::async, []() -> int {
+        throw test_exception{};
+    } );
+    auto result = pool.submit( std::launch::async, []( int x ) { return x; }, std::move( value ) );
+    REQUIRE_THROWS_AS( result.get(), test_exception );
+}
+
+TEST_CASE( "parked tasks on abort", "[task_pool][promises][stop_token]" )
+{
+    std::atomic_bool started{ false };
+    std::atomic_bool called{ false };
+    be::task_pool    pool( 1 );
+    auto             value = pool.submit< be::notifying_promise >(
+        std::launch::async, [&]( be::stop_token abort ) {
+            started = true;
+            while ( !abort )
+            {
+                std::this_thread::sleep_for( 1ms );
+            }
+            return 1;
+        } );
+    auto parked =
+        pool.submit( std::launch::async, [&]( int ) { called = true; }, std::move( value ) );
+    while ( !started )
+    {
+        std::this_thread::sleep_for( 1ms );
+    }
+    pool.abort();
+    REQUIRE_FALSE( called );
+    REQUIRE( pool.get_tasks_waiting() == 0 );
+}
+
+TEST_CASE( "parked tasks across pools", "[task_pool][promises]" )
+{
+    std::atomic_bool finish{ false };
+    be::task_pool    producer( 1 );
+    auto             value = producer.submit< be::notifying_promise >( std::launch::async, [&]() {
+        while ( !finish )
+        {
+            std::this_thread::sleep_for( 1ms );
+        }
+        return 1;
+    } );
+    {
+        be::task_pool consumer( 1 );
+        auto          parked =
+            consumer.submit( std::launch::async, []( int ) {}, std::move( value ) );
+        REQUIRE( consumer.get_tasks_waiting() == 1 );
+    }
+    finish = true;
+    producer.wait();
+}
+
+TEST_CASE( "be::promise", "[promises]" )
+{
+    STATIC_REQUIRE( be::is_promise_v< be::promise > );
+    STATIC_REQUIRE( be::future_api::is_notifying< be::future< int > >::value );
+    be::promise< int > promise;
+    be::future< int >  future = promise.get_future();
+    REQUIRE_THROWS_AS( promise.get_future(), std::future_error );
+    REQUIRE( future.wait_for( 1ms ) == std::future_status::timeout );
+    std::thread worker( [&]() { promise.set_value( 42 ); } );
+    future.wait();
+    worker.join();
+    REQUIRE( future.wait_until( std::chrono::steady_clock::now() ) == std::future_status::ready );
+    REQUIRE_THROWS_AS( promise.set_value( 1 ), std::future_error );
+    REQUIRE( future.get() == 42 );
+    REQUIRE_FALSE( future.valid() );
+}
+
+TEST_CASE( "be::promise reference and void", "[promises]" )
+{
+    int                 value = 1;
+    be::promise< int& > reference;
+    be::promise< void > nothing;
+    be::future< int& >  reference_future = reference.get_future();
+    be::future< void >  nothing_future   = nothing.get_future();
+    reference.set_value( value );
+    nothing.set_exception( std::make_exception_ptr( test_exception{} ) );
+    REQUIRE( &reference_future.get() == &value );
+    REQUIRE_THROWS_AS( nothing_future.get(), test_exception );
+}
+
+TEST_CASE( "be::promise continuation", "[promises]" )
+{
+    std::atomic_int        calls{ 0 };
+    auto                   count = []( void* x ) { ++( *static_cast< std::atomic_int* >( x ) ); };
+    be::continuation const next{ count, &calls };
+    be::future< void >     future;
+    {
+        be::promise< void > promise;
+        future = promise.get_future();
+        REQUIRE( future.set_continuation( next ) );
+        REQUIRE( future.set_continuation( next ) );
+        REQUIRE( calls == 0 );
+    }
+    REQUIRE( calls == 1 );
+    REQUIRE_FALSE( future.set_continuation( next ) );
+    REQUIRE_THROWS_AS( future.get(), std::future_error );
+}
+
+TEST_CASE( "be::future to std::future", "[promises]" )
+{
+    be::promise< int > promise;
+    std::future< int > future = promise.get_future();
+    REQUIRE( future.wait_for( 0s ) == std::future_status::timeout );
+    promise.set_value( 42 );
+    REQUIRE( future.get() == 42 );
+}
+
+TEST_CASE( "submit( be::future ) is parked", "[task_pool][submit][promises]" )
+{
+    std::atomic_bool finish{ false };
+    be::task_pool    pool( 2 );
+    auto             value = pool.submit< be::promise >( std::launch::async, [&]() {
+        while ( !finish )
+        {
+            std::this_thread::sleep_for( 1ms );
+        }
+        return 1;
+    } );
+    auto result = pool.submit< be::promise >(
+        std::launch::async, []( int x ) { return x + 1; }, std::move( value ) );
+    REQUIRE( pool.get_tasks_waiting() == 1 );
+    finish = true;
+    REQUIRE( result.get() == 2 );
+}
+
+TEST_CASE( "then", "[task_pool][continuations]" )
+{
+    be::task_pool      pool( 2 );
+    be::promise< int > promise;
+    auto               doubled = pool.then( promise.get_future(), []( int x ) { return 2 * x; } );
+    auto               result  = pool.then( std::move( doubled ), []( int x ) { return x + 1; } );
+    REQUIRE( pool.get_tasks_waiting() == 2 );
+    promise.set_value( 20 );
+    REQUIRE( result.get() == 41 );
+
+    be::promise< void > signal;
+    auto                after = pool.then( signal.get_future(), []() { return 3; } );
+    signal.set_value();
+    REQUIRE( after.get() == 3 );
+
+    // std::future can not notify and is polled
+    std::promise< int > polled;
+    auto                from_std = pool.then( polled.get_future(), []( int x ) { return x; } );
+    polled.set_value( 4 );
+    REQUIRE( from_std.get() == 4 );
+}
+
+TEST_CASE( "when_all", "[task_pool][continuations]" )
+{
+    be::task_pool                     pool( 2 );
+    std::vector< be::promise< int > > promises( 8 );
+    std::vector< be::future< int > >  futures;
+    for ( auto& promise : promises )
+    {
+        futures.push_back( promise.get_future() );
+    }
+    auto all = be::when_all( pool, std::move( futures ) );
+    REQUIRE( pool.get_tasks_waiting() == 1 );
+    for ( std::size_t i = promises.size(); i-- > 0; )
+    {
+        promises[i].set_value( static_cast< int >( i ) );
+    }
+    REQUIRE( all.get() == std::vector< int >{ 0, 1, 2, 3, 4, 5, 6, 7 } );
+
+    auto one = pool.submit< be::promise >( std::launch::async, []() { return 1; } );
+    auto two =
+        pool.submit< be::promise >( std::launch::async, []() { return std::string( "two" ); } );
+    auto values = be::when_all( pool, std::move( one ), std::move( two ) );
+    REQUIRE( values.get() == std::make_tuple( 1, std::string( "two" ) ) );
+
+    auto none = be::when_all( pool, std::vector< be::future< int > >{} );
+    REQUIRE( none.get().empty() );
+}
+
+TEST_CASE( "when_all void and throwing", "[task_pool][continuations][throws]" )
+{
+    be::task_pool                     pool( 2 );
+    std::atomic< int >                count{ 0 };
+    std::vector< be::future< void > > futures;
+    for ( int i = 0; i < 8; ++i )
+    {
+        futures.push_back(
+            pool.submit< be::promise >( std::launch::async, [&count]() { ++count; } ) );
+    }
+    be::when_all( pool, std::move( futures ) ).get();
+    REQUIRE( count == 8 );
+
+    std::vector< be::future< int > > failing;
+    failing.push_back( pool.submit< be::promise >( std::launch::async, []() { return 1; } ) );
+    failing.push_back( pool.submit< be::promise >( std::launch::async, []() -> int {
+        throw test_exception{};
+    } ) );
+    auto all = be::when_all( pool, std::move( failing ) );
+    REQUIRE_THROWS_AS( all.get(), test_exception );
+}
+
+TEST_CASE( "when_any", "[task_pool][continuations]" )
+{
+    be::task_pool                    pool( 2 );
+    be::promise< int >               first;
+    be::promise< int >               second;
+    std::vector< be::future< int > > futures;
+    futures.push_back( first.get_future() );
+    futures.push_back( second.get_future() );
+    auto any = be::when_any( pool, std::move( futures ) );
+    REQUIRE( pool.get_tasks_waiting() == 1 );
+    second.set_value( 2 );
+    auto result = any.get();
+    REQUIRE( result.index == 1 );
+    REQUIRE( result.futures[1].get() == 2 );
+
+    // the other futures are handed back without their continuation
+    first.set_value( 1 );
+    REQUIRE( result.futures[0].get() == 1 );
+
+    be::promise< std::string > text;
+    be::promise< void >        signal;
+    auto                       mixed = be::when_any( pool, text.get_future(), signal.get_future() );
+    signal.set_value();
+    text.set_value( "late" );
+    auto mixed_result = mixed.get();
+    REQUIRE( mixed_result.index == 1 );
+    REQUIRE( std::get< 0 >( mixed_result.futures ).get() == "late" );
+
+    auto none = be::when_any( pool, std::vector< be::future< int > >{} );
+    REQUIRE( none.get().index == static_cast< std::size_t >( -1 ) );
+}
+
+TEST_CASE( "submit_n", "[task_pool][submit][bulk]" )
+{
+    be::task_pool pool( 4 );
+    auto          futures = pool.submit_n( 100, []( std::size_t index ) { return index * 2; } );
+    REQUIRE( futures.size() == 100 );
+    for ( std::size_t i = 0; i < futures.size(); ++i )
+    {
+        REQUIRE( futures[i].get() == i * 2 );
+    }
+}
+
+TEST_CASE( "submit_bulk", "[task_pool][submit][bulk]" )
+{
+    be::task_pool      pool( 2 );
+    std::vector< int > values( 10 );
+    std::iota( values.begin(), values.end(), 0 );
+    std::atomic_int sum{ 0 };
+    auto            futures = pool.submit_bulk< be::promise >(
+        values.begin(), values.end(), [&sum]( int value ) { sum += value; } );
+    for ( auto& future : futures )
+    {
+        future.get();
+    }
+    REQUIRE( sum == 45 );
+}
+
+TEST_CASE( "submit_bulk paused and throwing", "[task_pool][submit][bulk][throws]" )
+{
+    be::task_pool pool( 2 );
+    pool.pause();
+    std::vector< int > values{ 1, 2, 3 };
+    auto               futures = pool.submit_bulk( values.begin(), values.end(), []( int value ) {
+        if ( value == 2 )
+        {
+            throw test_exception{};
+        }
+        return value;
+    } );
+    REQUIRE( pool.get_tasks_queued() == 3 );
+    pool.unpause();
+    REQUIRE( futures[0].get() == 1 );
+    REQUIRE_THROWS_AS( futures[1].get(), test_exception );
+    REQUIRE( futures[2].get() == 3 );
+}
+
+TEST_CASE( "submit_n and submit_bulk with options", "[task_pool][submit][bulk][stop_token]" )
+{
+    be::task_pool   pool( 1 );
+    be::stop_source source;
+    pool.pause();
+    auto high = pool.submit_n(
+        { std::launch::async, be::task_priority::high }, 2, []( std::size_t index ) {
+            return index;
+        } );
+    REQUIRE( pool.get_tasks_queued( be::task_priority::high ) == 2 );
+    auto cancelled = pool.submit_n( { std::launch::async, source.get_token() },
+                                    2,
+                                    []( std::size_t index ) { return index; } );
+    source.request_stop();
+    pool.unpause();
+    REQUIRE( high[1].get() == 1 );
+    REQUIRE_THROWS_AS( cancelled[0].get(), be::task_cancelled );
+    REQUIRE_THROWS_AS( cancelled[1].get(), be::task_cancelled );
+
+    std::vector< int > values{ 1, 2, 3 };
+    auto               deferred = pool.submit_bulk(
+        std::launch::deferred, values.begin(), values.end(), []( int value ) { return value; } );
+    REQUIRE( pool.get_tasks_queued() == 0 );
+    pool.invoke_deferred();
+    REQUIRE( deferred[0].get() + deferred[1].get() + deferred[2].get() == 6 );
+}
+
+TEST_CASE( "work stealing/submit_n", "[task_pool][work_stealing][bulk]" )
+{
+    be::pool_options options;
+    options.thread_count = 4;
+    options.scheduling   = be::schedule_policy::work_stealing;
+    be::task_pool pool( options );
+    auto          outer = pool.submit( std::launch::async, [&pool]() {
+        auto        inner = pool.submit_n( 64, []( std::size_t index ) { return index; } );
+        std::size_t sum   = 0;
+        for ( auto& future : inner )
+        {
+            sum += future.get();
+        }
+        return sum;
+    } );
+    REQUIRE( outer.get() == 63 * 64 / 2 );
+}
+
+TEST_CASE( "parallel_for", "[algorithms]" )
+{
+    be::task_pool      pool( 4 );
+    std::vector< int > values( 10'000, 1 );
+    be::parallel_for( pool, values.begin(), values.end(), []( int& value ) { value *= 2; } );
+    REQUIRE( std::all_of( values.begin(), values.end(), []( int value ) { return value == 2; } ) );
+
+    std::vector< std::atomic_int > counts( 1'000 );
+    be::parallel_for( pool, 0, 1'000, [&]( int index ) { ++counts[index]; }, 7 );
+    REQUIRE( std::all_of(
+        counts.begin(), counts.end(), []( std::atomic_int const& count ) { return count == 1; } ) );
+}
+
+TEST_CASE( "parallel_for throws", "[algorithms][throws]" )
+{
+    be::task_pool pool( 2 );
+    REQUIRE_THROWS_AS( be::parallel_for( pool,
+                                         0,
+                                         1'000,
+                                         []( int index ) {
+                                             if ( index == 500 )
+                                             {
+                                                 throw test_exception{};
+                                             }
+                                         } ),
+                       test_exception );
+    REQUIRE_NOTHROW(
+        be::parallel_for( pool, 0, 0, []( int /*index*/ ) { throw test_exception{}; } ) );
+}
+
+TEST_CASE( "parallel_for paused", "[algorithms]" )
+{
+    be::task_pool pool( 2 );
+    pool.pause();
+    std::atomic_int calls{ 0 };
+    be::parallel_for( pool, 0, 1'000, [&]( int /*index*/ ) { ++calls; } );
+    REQUIRE( calls == 1'000 );
+}
+
+TEST_CASE( "parallel_transform", "[algorithms]" )
+{
+    be::task_pool      pool( 4 );
+    std::vector< int > input( 5'000 );
+    std::vector< int > output( input.size() );
+    std::iota( input.begin(), input.end(), 0 );
+    auto end = be::parallel_transform(
+        pool, input.begin(), input.end(), output.begin(), []( int value ) { return value * 3; } );
+    REQUIRE( end == output.end() );
+    for ( std::size_t i = 0; i < output.size(); ++i )
+    {
+        REQUIRE( output[i] == input[i] * 3 );
+    }
+}
+
+TEST_CASE( "parallel_reduce", "[algorithms]" )
+{
+    be::task_pool              pool( 4 );
+    std::vector< std::size_t > values( 10'000 );
+    std::iota( values.begin(), values.end(), 1U );
+    auto sum = be::parallel_reduce(
+        pool, values.begin(), values.end(), std::size_t{ 0 }, std::plus<>{} );
+    REQUIRE( sum == 10'000U * 10'001U / 2U );
+
+    // concatenation is not commutative
+    std::vector< std::string > words{ "a", "b", "c", "d", "e", "f", "g", "h" };
+    auto                       text = be::parallel_reduce(
+        pool, words.begin(), words.end(), std::string{}, std::plus<>{}, 1 );
+    REQUIRE( text == "abcdefgh" );
+}
+
+TEST_CASE( "idle policies", "[task_pool][idle]" )
+{
+    for ( auto policy : { be::idle_policy::latency, be::idle_policy::power } )
+    {
+        be::pool_options options;
+        options.thread_count = 2;
+        options.idle         = policy;
+        be::task_pool pool( options );
+        REQUIRE( pool.get_idle_policy() == policy );
+
+        // threads are asleep without a timeout by now
+        std::this_thread::sleep_for( 5ms );
+        REQUIRE( pool.submit( std::launch::async, []() { return 1; } ).get() == 1 );
+
+        pool.pause();
+        auto paused = pool.submit( std::launch::async, []() { return 2; } );
+        std::this_thread::sleep_for( 5ms );
+        REQUIRE( pool.get_tasks_queued() == 1 );
+        pool.unpause();
+        REQUIRE( paused.get() == 2 );
+
+        // arguments that can not notify are still polled
+        std::promise< int > promise;
+        auto                polled =
+            pool.submit( std::launch::async, []( int x ) { return x; }, promise.get_future() );
+        std::this_thread::sleep_for( 5ms );
+        promise.set_value( 3 );
+        REQUIRE( polled.get() == 3 );
+        pool.wait();
+        REQUIRE( pool.get_tasks_total() == 0 );
+    }
+}
+
+TEST_CASE( "task priorities", "[task_pool][priority]" )
+{
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.priority_aging = 0;
+    be::task_pool pool( options );
+    REQUIRE( pool.get_priority_levels() == 3 );
+
+    std::vector< int >                 order;
+    std::vector< std::future< void > > done;
+    pool.pause();
+    for ( int i = 0; i < 3; ++i )
+    {
+        done.push_back( pool.submit( { std::launch::async, be::task_priority::low }, [&order]() {
+            order.push_back( 3 );
+        } ) );
+        done.push_back( pool.submit( std::launch::async, [&order]() { order.push_back( 2 ); } ) );
+        done.push_back( pool.submit( { std::launch::async, be::task_priority::high }, [&order]() {
+            order.push_back( 1 );
+        } ) );
+    }
+    REQUIRE( pool.get_tasks_queued() == 9 );
+    REQUIRE( pool.get_tasks_queued( be::task_priority::high ) == 3 );
+    REQUIRE( pool.get_tasks_queued( be::task_priority::normal ) == 3 );
+    REQUIRE( pool.get_tasks_queued( be::task_priority::low ) == 3 );
+    pool.unpause();
+    pool.wait();
+    REQUIRE( order == std::vector< int >{ 1, 1, 1, 2, 2, 2, 3, 3, 3 } );
+    REQUIRE( pool.get_tasks_queued( be::task_priority::low ) == 0 );
+}
+
+TEST_CASE( "task priorities/aging", "[task_pool][priority]" )
+{
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.priority_aging = 2;
+    be::task_pool pool( options );
+
+    std::vector< int >                 order;
+    std::vector< std::future< void > > done;
+    std::function< void() >            high = [&]() {
+        order.push_back( 1 );
+        if ( order.size() < 9 )
+        {
+            // a steady stream of high priority tasks
+            done.push_back( pool.submit( { std::launch::async, be::task_priority::high }, high ) );
+        }
+    };
+    pool.pause();
+    done.push_back( pool.submit( { std::launch::async, be::task_priority::low }, [&order]() {
+        order.push_back( 3 );
+    } ) );
+    done.push_back( pool.submit( { std::launch::async, be::task_priority::high }, high ) );
+    pool.unpause();
+    pool.wait();
+    // two levels apart the low priority task ties after four and wins after six dispatches
+    REQUIRE( order == std::vector< int >{ 1, 1, 1, 1, 1, 1, 3, 1, 1 } );
+}
+
+TEST_CASE( "task priorities/levels", "[task_pool][priority]" )
+{
+    be::pool_options options;
+    options.thread_count    = 1;
+    options.priority_levels = 5;
+    be::task_pool pool( options );
+    REQUIRE( pool.get_priority_levels() == 5 );
+    pool.pause();
+    auto lowest = pool.submit( { std::launch::async, static_cast< be::task_priority >( 4 ) },
+                               []() { return 4; } );
+    auto beyond = pool.submit( { std::launch::async, static_cast< be::task_priority >( 9 ) },
+                               []() { return 9; } );
+    REQUIRE( pool.get_tasks_queued( static_cast< be::task_priority >( 4 ) ) == 2 );
+    pool.unpause();
+    REQUIRE( lowest.get() + beyond.get() == 13 );
+
+    options.priority_levels = 0;
+    be::task_pool single( options );
+    REQUIRE( single.get_priority_levels() == 1 );
+    REQUIRE( single.submit( { std::launch::async, be::task_priority::low }, []() { return 1; } )
+                 .get() == 1 );
+}
+
+TEST_CASE( "ready queues/mpmc_queue", "[queues]" )
+{
+    auto counted = std::make_shared< int >( 0 );
+    {
+        // a ring of four cells spills the rest into the overflow queue
+        be::mpmc_queue< std::shared_ptr< int >, 4 > queue;
+        for ( int i = 0; i < 10; ++i )
+        {
+            queue.push( std::make_shared< int >( i ) );
+        }
+        std::shared_ptr< int > value;
+        for ( int i = 0; i < 10; ++i )
+        {
+            REQUIRE( queue.try_pop( value ) );
+            REQUIRE( *value == i );
+        }
+        REQUIRE_FALSE( queue.try_pop( value ) );
+
+        // values left behind are destroyed with the queue
+        std::vector< std::shared_ptr< int > > values( 6, counted );
+        queue.push( values.begin(), values.end() );
+        REQUIRE( counted.use_count() == 7 );
+    }
+    REQUIRE( counted.use_count() == 1 );
+}
+
+TEST_CASE( "ready queues/mpmc_queue threads", "[queues]" )
+{
+    constexpr int                      threads = 4;
+    constexpr int                      count   = 10000;
+    be::mpmc_queue< int, 64 >          queue;
+    std::atomic< long long >           sum{ 0 };
+    std::atomic_int                    popped{ 0 };
+    std::vector< std::future< void > > done;
+    for ( int t = 0; t < threads; ++t )
+    {
+        done.push_back( std::async( std::launch::async, [&queue]() {
+            for ( int i = 1; i <= count; ++i )
+            {
+                queue.push( i );
+            }
+        } ) );
+        done.push_back( std::async( std::launch::async, [&]() {
+            int value = 0;
+            while ( popped < threads * count )
+            {
+                if ( queue.try_pop( value ) )
+                {
+                    sum += value;
+                    ++popped;
+                }
+            }
+        } ) );
+    }
+    for ( auto& future : done )
+    {
+        future.get();
+    }
+    REQUIRE( sum == threads * ( static_cast< long long >( count ) * ( count + 1 ) / 2 ) );
+}
+
+TEST_CASE( "ready queues/lock free pool", "[task_pool][queues]" )
+{
+    using ready_queue    = be::lock_free_ready_queue< 8 >;
+    using lock_free_pool = be::task_pool_t< std::allocator< void >, ready_queue >;
+    static_assert( be::is_pool< lock_free_pool >::value, "lock free pools are pools" );
+
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.priority_aging = 0;
+    lock_free_pool pool( options );
+
+    // more tasks than cells keep their order of priority and submission
+    std::vector< int >                 order;
+    std::vector< std::future< void > > done;
+    pool.pause();
+    for ( int i = 0; i < 10; ++i )
+    {
+        done.push_back( pool.submit( { std::launch::async, be::task_priority::low }, [&order, i]() {
+            order.push_back( 100 + i );
+        } ) );
+        done.push_back(
+            pool.submit( std::launch::async, [&order, i]() { order.push_back( i ); } ) );
+    }
+    REQUIRE( pool.get_tasks_queued() == 20 );
+    pool.unpause();
+    pool.wait();
+    std::vector< int > expected( 10 );
+    std::iota( expected.begin(), expected.end(), 0 );
+    for ( int i = 0; i < 10; ++i )
+    {
+        expected.push_back( 100 + i );
+    }
+    REQUIRE( order == expected );
+
+    pool.reset( 4 );
+    auto futures = pool.submit_n( 1000, []( std::size_t index ) { return index; } );
+    std::size_t sum = 0;
+    for ( auto& future : futures )
+    {
+        sum += future.get();
+    }
+    REQUIRE( sum == 999 * 1000 / 2 );
+
+    std::atomic_int calls{ 0 };
+    be::parallel_for( pool, 0, 1000, [&calls]( int ) { ++calls; } );
+    REQUIRE( calls == 1000 );
+    auto result = pool | []() { return 20; } | []( int value ) { return value + 1; };
+    REQUIRE( result.get() == 21 );
+}
+
+TEST_CASE( "work stealing/priorities", "[task_pool][work_stealing][priority]" )
+{
+    be::pool_options options;
+    options.thread_count = 1;
+    options.scheduling   = be::schedule_policy::work_stealing;
+    be::task_pool                      pool( options );
+    std::vector< int >                 order;
+    std::vector< std::future< void > > done;
+    auto                               outer = pool.submit( std::launch::async, [&]() {
+        // normal tasks go to the local deque, the others to the shared queues
+        done.push_back( pool.submit( { std::launch::async, be::task_priority::low }, [&order]() {
+            order.push_back( 3 );
+        } ) );
+        done.push_back( pool.submit( std::launch::async, [&order]() { order.push_back( 2 ); } ) );
+        done.push_back( pool.submit( { std::launch::async, be::task_priority::high }, [&order]() {
+            order.push_back( 1 );
+        } ) );
+    } );
+    outer.get();
+    pool.wait();
+    REQUIRE( order == std::vector< int >{ 1, 2, 3 } );
+}
+
+#if BE_TASK_STATS
+TEST_CASE( "stats", "[task_pool][stats]" )
+{
+    be::task_pool pool( 2 );
+    REQUIRE( pool.stats().workers.size() == 2 );
+
+    // threads are asleep after this
+    std::this_thread::sleep_for( 5ms );
+    pool.pause();
+    std::vector< std::future< void > > done;
+    for ( int i = 0; i < 10; ++i )
+    {
+        done.push_back(
+            pool.submit( std::launch::async, []() { std::this_thread::sleep_for( 1ms ); } ) );
+    }
+    std::this_thread::sleep_for( 1ms );
+    pool.unpause();
+    pool.wait();
+
+    auto const total = pool.stats().total();
+    REQUIRE( total.tasks_executed == 10 );
+    REQUIRE( total.busy_time >= 10ms );
+    REQUIRE( total.queue_wait_time >= 10ms );
+
+    // the thread polling the argument sleeps and wakes up every check latency, on a loaded
+    // machine the threads may not have slept before
+    std::promise< int > promise;
+    auto                polled =
+        pool.submit( std::launch::async, []( int x ) { return x; }, promise.get_future() );
+    auto slept = [&pool] {
+        auto const now = pool.stats().total();
+        return now.idle_time > 0ms && now.wakeups >= 1;
+    };
+    for ( int i = 0; i < 10'000 && !slept(); ++i )
+    {
+        std::this_thread::sleep_for( 1ms );
+    }
+    REQUIRE( slept() );
+    promise.set_value( 1 );
+    REQUIRE( polled.get() == 1 );
+    REQUIRE( pool.stats().total().checker_time > 0ms );
+
+    pool.reset();
+    REQUIRE( pool.stats().total().tasks_executed == 0 );
+}
+
+TEST_CASE( "stats/single poller", "[task_pool][stats]" )
+{
+    be::pool_options options;
+    options.thread_count  = 8;
+    options.check_latency = std::chrono::milliseconds( 1 );
+    options.idle          = be::idle_policy::power;
+    be::task_pool pool( options );
+
+    // one thread wakes up every check_latency to poll and hands over to another, the rest sleep
+    std::promise< int > promise;
+    auto                polled =
+        pool.submit( std::launch::async, []( int x ) { return x; }, promise.get_future() );
+    std::this_thread::sleep_for( 50ms );
+    auto const wakeups = pool.stats().total().wakeups;
+    promise.set_value( 1 );
+    REQUIRE( polled.get() == 1 );
+    REQUIRE( wakeups < 3U * 50U );
+}
+#endif
+
+TEST_CASE( "numa/parse_cpu_list", "[task_pool][numa]" )
+{
+    REQUIRE( be::detail::parse_cpu_list( "0-3,8,10-11" ) ==
+             std::vector< unsigned >{ 0, 1, 2, 3, 8, 10, 11 } );
+    REQUIRE( be::detail::parse_cpu_list( "" ).empty() );
+    REQUIRE( be::detail::parse_cpu_list( "x,3-1,5,6-" ) == std::vector< unsigned >{ 5 } );
+}
+
+TEST_CASE( "numa/read_numa_topology", "[task_pool][numa]" )
+{
+    REQUIRE( be::read_numa_topology( "/this/path/does/not/exist" ).empty() );
+#if defined( __linux__ )
+    // a fake sysfs tree with a memory only node and a file that is not a node
+    std::array< char, 32 > root{ "/tmp/task_pool_numa_XXXXXX" };
+    REQUIRE( mkdtemp( root.data() ) != nullptr );
+    std::string const base = root.data();
+    for ( auto const& node : { std::make_pair( "node0", "0-1\n" ),
+                               std::make_pair( "node1", "2,3\n" ),
+                               std::make_pair( "node2", "\n" ) } )
+    {
+        REQUIRE( mkdir( ( base + "/" + node.first ).c_str(), 0700 ) == 0 );
+        std::ofstream( base + "/" + node.first + "/cpulist" ) << node.second;
+    }
+    std::ofstream( base + "/possible" ) << "0-2\n";
+
+    auto const topology = be::read_numa_topology( base );
+    REQUIRE( topology.size() == 2 );
+    REQUIRE( topology[0].id == 0 );
+    REQUIRE( topology[0].cpus == std::vector< unsigned >{ 0, 1 } );
+    REQUIRE( topology[1].id == 1 );
+    REQUIRE( topology[1].cpus == std::vector< unsigned >{ 2, 3 } );
+
+    for ( auto const* node : { "node0", "node1", "node2" } )
+    {
+        std::remove( ( base + "/" + node + "/cpulist" ).c_str() );
+        rmdir( ( base + "/" + node ).c_str() );
+    }
+    std::remove( ( base + "/possible" ).c_str() );
+    rmdir( base.c_str() );
+#endif
+}
+
+TEST_CASE( "numa/node groups", "[task_pool][numa]" )
+{
+    // two nodes sharing the first processor so the test runs on any machine
+    be::pool_options options;
+    options.thread_count = 4;
+    options.numa         = be::numa_policy::node_groups;
+    options.topology     = { { 0, { 0 } }, { 1, { 0 } } };
+    be::task_pool pool( options );
+    REQUIRE( pool.get_numa_policy() == be::numa_policy::node_groups );
+    REQUIRE( pool.get_numa_nodes() == 2 );
+
+    std::atomic_int                    count{ 0 };
+    std::vector< std::future< void > > futures;
+    pool.pause();
+    for ( int i = 0; i < 8; ++i )
+    {
+        futures.push_back( pool.submit( std::launch::async, [&]() { ++count; } ) );
+    }
+    futures.push_back(
+        pool.submit( { std::launch::async, be::task_priority::low }, [&]() { ++count; } ) );
+    REQUIRE( pool.get_tasks_queued() == 9 );
+    REQUIRE( pool.get_tasks_queued( be::task_priority::normal ) == 8 );
+    pool.unpause();
+    pool.wait();
+    REQUIRE( count == 9 );
+
+    // tasks submitted from the pool are queued on the node of their parent
+    auto nested = pool.submit( std::launch::async, [&]() {
+        std::vector< std::future< void > > children;
+        for ( int i = 0; i < 100; ++i )
+        {
+            children.push_back( pool.submit( std::launch::async, [&]() { ++count; } ) );
+        }
+        for ( auto& child : children )
+        {
+            child.wait();
+        }
+    } );
+    nested.get();
+    REQUIRE( count == 109 );
+
+    pool.reset( 1 );
+    REQUIRE( pool.get_numa_nodes() == 1 );
+    pool.reset( 2 );
+    REQUIRE( pool.get_numa_nodes() == 2 );
+}
+
+TEST_CASE( "numa/work stealing", "[task_pool][numa][work_stealing]" )
+{
+    be::pool_options options;
+    options.thread_count = 4;
+    options.scheduling   = be::schedule_policy::work_stealing;
+    options.numa         = be::numa_policy::node_groups;
+    options.topology     = { { 0, { 0 } }, { 1, { 0 } } };
+    be::task_pool   pool( options );
+    std::atomic_int count{ 0 };
+    for ( int i = 0; i < 10; ++i )
+    {
+        auto future = pool.submit( std::launch::async, [&]() {
+            for ( int j = 0; j < 10; ++j )
+            {
+                auto child = pool.submit( std::launch::async, [&]() { ++count; } );
+            }
+        } );
+    }
+    pool.wait();
+    REQUIRE( count == 100 );
+    REQUIRE( pool.get_tasks_total() == 0 );
+}
+
+TEST_CASE( "thread options/hooks", "[task_pool][threads]" )
+{
+    std::mutex              mutex;
+    std::vector< unsigned > started;
+    std::atomic_int         stopped{ 0 };
+    {
+        be::pool_options options;
+        options.thread_count     = 3;
+        options.threads.on_start = [&]( unsigned index ) {
+            std::unique_lock< std::mutex > lock( mutex );
+            started.push_back( index );
+        };
+        options.threads.on_stop = [&]( unsigned ) { ++stopped; };
+        be::task_pool pool( options );
+        pool.submit( std::launch::async, []() {} ).wait();
+        REQUIRE( pool.get_thread_options().on_start );
+    }
+    std::sort( started.begin(), started.end() );
+    REQUIRE( started == std::vector< unsigned >{ 0, 1, 2 } );
+    REQUIRE( stopped == 3 );
+}
+
+#if defined( __linux__ )
+TEST_CASE( "thread options/linux", "[task_pool][threads]" )
+{
+    be::pool_options options;
+    options.thread_count        = 2;
+    options.threads.cpu_sets    = { { 0 } };
+    options.threads.name_prefix = "tp-worker-";
+    options.threads.stack_size  = 4U << 20U;
+    options.threads.policy      = be::thread_policy::batch;
+    options.threads.nice        = 5;
+    be::task_pool pool( options );
+
+    struct settings
+    {
+        std::string name;
+        std::size_t stack_size = 0;
+        int         cpu        = -1;
+        int         policy     = -1;
+        int         nice       = 0;
+    };
+    auto current = pool.submit( std::launch::async, []() {
+        settings result;
+        std::array< char, 16 > name{};
+        pthread_getname_np( pthread_self(), name.data(), name.size() );
+        result.name = name.data();
+        pthread_attr_t attributes;
+        pthread_getattr_np( pthread_self(), &attributes );
+        pthread_attr_getstacksize( &attributes, &result.stack_size );
+        pthread_attr_destroy( &attributes );
+        result.cpu    = sched_getcpu();
+        result.policy = sched_getscheduler( 0 );
+        result.nice   = getpriority( PRIO_PROCESS, static_cast< id_t >( syscall( SYS_gettid ) ) );
+        return result;
+    } );
+    settings const result = current.get();
+    REQUIRE( result.name.compare( 0, 10, "tp-worker-" ) == 0 );
+    REQUIRE( result.stack_size >= options.threads.stack_size );
+    REQUIRE( result.cpu == 0 );
+    REQUIRE( result.policy == SCHED_BATCH );
+    REQUIRE( result.nice == 5 );
+
+    // the settings survive resetting the pool
+    pool.reset( 1 );
+    REQUIRE( pool.get_thread_options().name_prefix == "tp-worker-" );
+}
+#endif
+
+namespace {
+template< typename Predicate >
+bool eventually( Predicate predicate )
+{
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+    while ( !predicate() )
+    {
+        if ( std::chrono::steady_clock::now() > deadline )
+        {
+            return false;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE( "scaling/set_thread_count", "[task_pool][threads]" )
+{
+    std::atomic_int  stopped{ 0 };
+    be::pool_options options;
+    options.thread_count    = 4;
+    options.threads.on_stop = [&]( unsigned ) { ++stopped; };
+    be::task_pool pool( options );
+    REQUIRE( pool.get_thread_capacity() == 4 );
+
+    // surplus threads exit on their own time
+    pool.set_thread_count( 2 );
+    REQUIRE( eventually( [&] { return stopped == 2; } ) );
+    REQUIRE( pool.get_thread_count() == 2 );
+    REQUIRE( pool.submit( std::launch::async, []() { return 1; } ).get() == 1 );
+
+    // limited to the capacity and at least one
+    pool.set_thread_count( 8 );
+    REQUIRE( pool.get_thread_count() == 4 );
+    pool.set_thread_count( 0 );
+    REQUIRE( eventually( [&] { return stopped == 5; } ) );
+    REQUIRE( pool.get_thread_count() == 1 );
+
+    // all threads take part again
+    pool.set_thread_count( 4 );
+    std::atomic_int started{ 0 };
+    std::vector< std::future< void > > futures;
+    for ( int i = 0; i < 4; ++i )
+    {
+        futures.push_back( pool.submit( std::launch::async, [&started]() {
+            ++started;
+            while ( started != 4 )
+            {
+                std::this_thread::yield();
+            }
+        } ) );
+    }
+    for ( auto& future : futures )
+    {
+        future.get();
+    }
+    REQUIRE( pool.get_thread_count() == 4 );
+}
+
+TEST_CASE( "scaling/elastic", "[task_pool][threads]" )
+{
+    be::pool_options options;
+    options.thread_count     = 1;
+    options.max_thread_count = 4;
+    options.keep_alive       = std::chrono::milliseconds( 20 );
+    options.grow_queue_wait  = std::chrono::milliseconds( 1 );
+    be::task_pool pool( options );
+    REQUIRE( pool.get_thread_count() == 1 );
+    REQUIRE( pool.get_thread_capacity() == 4 );
+
+    // the tasks only finish once they all run at the same time which takes more threads
+    std::atomic_int                    started{ 0 };
+    std::vector< std::future< void > > futures;
+    for ( int i = 0; i < 4; ++i )
+    {
+        futures.push_back( pool.submit( std::launch::async, [&started]() {
+            ++started;
+            while ( started != 4 )
+            {
+                std::this_thread::yield();
+            }
+        } ) );
+    }
+    for ( auto& future : futures )
+    {
+        future.get();
+    }
+    REQUIRE( pool.get_thread_count() > 1 );
+
+    // idle threads above the minimum exit after the keep alive
+    REQUIRE( eventually( [&] { return pool.get_thread_count() == 1; } ) );
+    REQUIRE( pool.submit( std::launch::async, []() { return 1; } ).get() == 1 );
+
+    // the minimum is limited to the capacity as well
+    pool.set_thread_count( 6 );
+    REQUIRE( pool.get_thread_count() == 4 );
+}
+
+namespace {
+template< typename Future >
+bool is_broken( Future& future )
+{
+    try
+    {
+        future.get();
+    }
+    catch ( std::future_error const& error )
+    {
+        return error.code() == std::future_errc::broken_promise;
+    }
+    return false;
+}
+} // namespace
+
+TEST_CASE( "queue capacity/reject", "[task_pool][capacity]" )
+{
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.queue_capacity = 2;
+    options.overflow       = be::overflow_policy::reject;
+    be::task_pool pool( options );
+    REQUIRE( pool.get_queue_capacity() == 2 );
+    REQUIRE( pool.get_overflow_policy() == be::overflow_policy::reject );
+
+    pool.pause();
+    auto first    = pool.submit( std::launch::async, []() { return 1; } );
+    auto deferred = pool.submit( std::launch::deferred, []() { return 2; } );
+    auto rejected = pool.submit( std::launch::async, []() { return 3; } );
+    auto tried    = pool.try_submit( std::launch::async, []() { return 4; } );
+    REQUIRE( pool.get_tasks_queued() == 1 );
+    REQUIRE( is_broken( rejected ) );
+    REQUIRE_FALSE( tried.valid() );
+
+    // tasks waiting for their arguments count as well
+    pool.invoke_deferred();
+    std::promise< int > argument;
+    auto waiting = pool.submit( std::launch::async, []( int value ) { return value; },
+                                argument.get_future() );
+    REQUIRE( pool.get_tasks_waiting() == 1 );
+    REQUIRE_FALSE( pool.try_submit( std::launch::async, []() {} ).valid() );
+
+    pool.unpause();
+    argument.set_value( 5 );
+    REQUIRE( first.get() + deferred.get() + waiting.get() == 8 );
+    auto accepted = pool.try_submit( std::launch::async, []() { return 6; } );
+    REQUIRE( accepted.valid() );
+    REQUIRE( accepted.get() == 6 );
+}
+
+TEST_CASE( "queue capacity/caller_runs", "[task_pool][capacity]" )
+{
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.queue_capacity = 1;
+    options.overflow       = be::overflow_policy::caller_runs;
+    be::task_pool pool( options );
+
+    pool.pause();
+    auto queued = pool.submit( std::launch::async, []() { return std::this_thread::get_id(); } );
+    auto inline_run =
+        pool.submit( std::launch::async, []() { return std::this_thread::get_id(); } );
+    REQUIRE( inline_run.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready );
+    REQUIRE( inline_run.get() == std::this_thread::get_id() );
+
+    // batches run on the caller as a whole
+    auto batch = pool.submit_n( 3, []( std::size_t index ) { return index; } );
+    REQUIRE( batch[2].wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready );
+    pool.unpause();
+    REQUIRE( queued.get() != std::this_thread::get_id() );
+}
+
+TEST_CASE( "queue capacity/drop_oldest", "[task_pool][capacity]" )
+{
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.queue_capacity = 2;
+    options.overflow       = be::overflow_policy::drop_oldest;
+    be::task_pool pool( options );
+
+    pool.pause();
+    auto low    = pool.submit( { std::launch::async, be::task_priority::low }, []() { return 1; } );
+    auto normal = pool.submit( std::launch::async, []() { return 2; } );
+    auto newest = pool.submit( std::launch::async, []() { return 3; } );
+    REQUIRE( pool.get_tasks_queued() == 2 );
+    REQUIRE( is_broken( low ) );
+    pool.unpause();
+    REQUIRE( normal.get() + newest.get() == 5 );
+}
+
+TEST_CASE( "queue capacity/bulk", "[task_pool][capacity][bulk]" )
+{
+    std::size_t const capacity = 4;
+    be::pool_options  options;
+    options.thread_count   = 1;
+    options.queue_capacity = capacity;
+    options.overflow       = be::overflow_policy::reject;
+    {
+        // batches are queued up to the room left, the rest is rejected
+        be::task_pool pool( options );
+        pool.pause();
+        auto futures = pool.submit_n( 10 * capacity, []( std::size_t index ) { return index; } );
+        REQUIRE( pool.get_tasks_queued() == capacity );
+        REQUIRE( is_broken( futures[capacity] ) );
+        REQUIRE( is_broken( futures.back() ) );
+        pool.unpause();
+        REQUIRE( futures[capacity - 1].get() == capacity - 1 );
+    }
+
+    // blocked batches are queued in chunks as room is made
+    options.overflow = be::overflow_policy::block;
+    be::task_pool              pool( options );
+    std::atomic< std::size_t > most_queued{ 0 };
+    auto futures = pool.submit_n( 10 * capacity, [&pool, &most_queued]( std::size_t index ) {
+        std::size_t const queued = pool.get_tasks_queued();
+        std::size_t       most   = most_queued.load();
+        while ( queued > most && !most_queued.compare_exchange_weak( most, queued ) )
+        {
+        }
+        return index;
+    } );
+    REQUIRE( pool.get_tasks_queued() <= capacity );
+    for ( std::size_t i = 0; i < futures.size(); ++i )
+    {
+        REQUIRE( futures[i].get() == i );
+    }
+    REQUIRE( most_queued <= capacity );
+}
+
+TEST_CASE( "queue capacity/block", "[task_pool][capacity]" )
+{
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.queue_capacity = 1;
+    be::task_pool pool( options );
+    REQUIRE( pool.get_overflow_policy() == be::overflow_policy::block );
+
+    std::promise< void > release;
+    auto                 busy   = release.get_future().share();
+    auto                 first  = pool.submit( std::launch::async, [busy]() { busy.wait(); } );
+    auto                 second = pool.submit( std::launch::async, []() { return 2; } );
+    REQUIRE( eventually( [&] { return pool.get_tasks_running() == 1; } ) );
+
+    // the queue holds second so the next submitter waits for it to start
+    std::atomic_bool submitted{ false };
+    auto             blocked = std::async( std::launch::async, [&]() {
+        auto third = pool.submit( std::launch::async, []() { return 3; } );
+        submitted  = true;
+        return third.get();
+    } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    REQUIRE_FALSE( submitted );
+    release.set_value();
+    REQUIRE( blocked.get() == 3 );
+    REQUIRE( second.get() == 2 );
+
+    // threads of the pool run the task themselves instead of blocking
+    std::future< int > inner;
+    auto               outer = pool.submit( std::launch::async, [&pool, &inner]() {
+        pool.pause();
+        inner      = pool.submit( std::launch::async, []() { return 4; } );
+        auto other = pool.submit( std::launch::async, []() { return 5; } );
+        auto ready = other.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready;
+        pool.unpause();
+        return ready ? other.get() : 0;
+    } );
+    REQUIRE( outer.get() == 5 );
+    REQUIRE( inner.get() == 4 );
+}
+
+TEST_CASE( "queue capacity/block on deferred tasks", "[task_pool][capacity]" )
+{
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.queue_capacity = 2;
+    be::task_pool pool( options );
+
+    // only invoke_deferred makes room for deferred tasks so the blocked submitter runs them
+    auto first  = pool.submit( std::launch::deferred, []() { return 1; } );
+    auto second = pool.submit( std::launch::deferred, []() { return 2; } );
+    auto third  = pool.submit( std::launch::deferred, []() { return 3; } );
+    REQUIRE( first.wait_for( 0s ) == std::future_status::ready );
+    REQUIRE( second.get() == 2 );
+    REQUIRE( first.get() == 1 );
+    pool.invoke_deferred();
+    REQUIRE( third.get() == 3 );
+
+    // deferred tasks still waiting for their arguments leave no room so the task is rejected
+    std::promise< int > input_a;
+    std::promise< int > input_b;
+    auto                waiting_a = pool.submit(
+        std::launch::deferred, []( int x ) { return x; }, input_a.get_future() );
+    auto waiting_b = pool.submit(
+        std::launch::deferred, []( int x ) { return x; }, input_b.get_future() );
+    auto rejected = pool.submit( std::launch::deferred, []() { return 4; } );
+    REQUIRE( is_broken( rejected ) );
+    input_a.set_value( 5 );
+    input_b.set_value( 6 );
+    pool.invoke_deferred();
+    REQUIRE( waiting_a.get() == 5 );
+    REQUIRE( waiting_b.get() == 6 );
+}
+
+TEST_CASE( "help while waiting/wait", "[task_pool][help]" )
+{
+    be::task_pool pool( 1 );
+
+    // the only thread waits for the tasks it submitted by running them
+    auto outer = pool.submit( std::launch::async, [&pool]() {
+        auto const                                    self = std::this_thread::get_id();
+        std::vector< std::future< std::thread::id > > children;
+        for ( int i = 0; i < 4; ++i )
+        {
+            children.push_back(
+                pool.submit( std::launch::async, []() { return std::this_thread::get_id(); } ) );
+        }
+        pool.wait();
+        bool same = true;
+        for ( auto& child : children )
+        {
+            same = same && child.get() == self;
+        }
+        return same;
+    } );
+    REQUIRE( outer.get() );
+
+    // a thread outside the pool helps while the pool thread is busy
+    std::atomic_int  helped{ 0 };
+    std::atomic_bool started{ false };
+    auto             busy = pool.submit( std::launch::async, [&helped, &started]() {
+        started = true;
+        while ( helped < 3 )
+        {
+            std::this_thread::yield();
+        }
+    } );
+    REQUIRE( eventually( [&] { return started.load(); } ) );
+    auto const                         main_thread = std::this_thread::get_id();
+    std::vector< std::future< void > > helpers;
+    for ( int i = 0; i < 3; ++i )
+    {
+        helpers.push_back( pool.submit( std::launch::async, [&helped, main_thread]() {
+            if ( std::this_thread::get_id() == main_thread )
+            {
+                ++helped;
+            }
+        } ) );
+    }
+    pool.wait();
+    REQUIRE( helped == 3 );
+    REQUIRE( pool.get_tasks_total() == 0 );
+#if BE_TASK_STATS
+    REQUIRE( pool.stats().helpers.tasks_executed == 3 );
+#endif
+}
+
+TEST_CASE( "help while waiting/concurrent waiters", "[task_pool][help]" )
+{
+    be::task_pool pool( 2 );
+
+    // both threads run a task waiting for the pool, each must not wait for the other
+    auto waiter = [&pool]( bool timed ) {
+        return [&pool, timed]() {
+            auto child = pool.submit( std::launch::async, []() { return 1; } );
+            if ( timed )
+            {
+                return pool.wait_for( 3s ) == std::future_status::ready ? child.get() : 0;
+            }
+            pool.wait();
+            return child.get();
+        };
+    };
+    auto first  = pool.submit( std::launch::async, waiter( false ) );
+    auto second = pool.submit( std::launch::async, waiter( false ) );
+    REQUIRE( first.wait_for( 3s ) == std::future_status::ready );
+    REQUIRE( second.wait_for( 3s ) == std::future_status::ready );
+    REQUIRE( first.get() + second.get() == 2 );
+
+    auto timed       = pool.submit( std::launch::async, waiter( true ) );
+    auto other_timed = pool.submit( std::launch::async, waiter( true ) );
+    REQUIRE( timed.get() + other_timed.get() == 2 );
+    pool.wait();
+    REQUIRE( pool.get_tasks_total() == 0 );
+}
+
+namespace {
+int fibonacci( be::task_pool& pool, int n )
+{
+    if ( n < 2 )
+    {
+        return n;
+    }
+    auto lhs =
+        pool.submit< be::promise >( std::launch::async, &fibonacci, std::ref( pool ), n - 1 );
+    int const rhs = fibonacci( pool, n - 2 );
+    return lhs.get() + rhs;
+}
+} // namespace
+
+TEST_CASE( "help while waiting/future get", "[task_pool][help][promises]" )
+{
+    be::task_pool pool( 1 );
+    auto          child = pool.submit< be::promise >( std::launch::async, [&pool]() {
+        auto inner = pool.submit< be::promise >( std::launch::async,
+                                                 []() { return std::this_thread::get_id(); } );
+        return inner.get() == std::this_thread::get_id();
+    } );
+    REQUIRE( child.get() );
+
+    // every level waits in get, far more levels than threads
+    be::task_pool fib_pool( 2 );
+    auto          result = fib_pool.submit< be::promise >(
+        std::launch::async, &fibonacci, std::ref( fib_pool ), 16 );
+    REQUIRE( result.get() == 987 );
+}
+
+TEST_CASE( "task group/wait", "[task_pool][group]" )
+{
+    be::task_pool   pool( 2 );
+    be::task_group  group( pool );
+    std::atomic_int count{ 0 };
+    for ( int i = 0; i < 100; ++i )
+    {
+        group.run( [&count]() { ++count; } );
+    }
+    group.wait();
+    REQUIRE( count == 100 );
+
+    // groups may be used again after waiting
+    group.run( { std::launch::async, be::task_priority::high }, [&count]() { ++count; } );
+    group.wait();
+    REQUIRE( count == 101 );
+}
+
+TEST_CASE( "task group/exceptions", "[task_pool][group]" )
+{
+    be::task_pool   pool( 1 );
+    be::task_group  group( pool );
+    std::atomic_int skipped{ 0 };
+    pool.pause();
+    group.run( []() { throw std::runtime_error( "failed" ); } );
+    for ( int i = 0; i < 3; ++i )
+    {
+        group.run( [&skipped]() { ++skipped; } );
+    }
+    pool.unpause();
+    // wait() would run the queued tasks alongside the thread of the pool
+    REQUIRE( eventually( [&group] { return group.is_cancelled(); } ) );
+    REQUIRE_THROWS_AS( group.wait(), std::runtime_error );
+    // the error cancelled the tasks that had not started
+    REQUIRE( skipped == 0 );
+
+    REQUIRE_FALSE( group.is_cancelled() );
+    group.run( [&skipped]() { ++skipped; } );
+    REQUIRE_NOTHROW( group.wait() );
+    REQUIRE( skipped == 1 );
+}
+
+TEST_CASE( "task group/cancel", "[task_pool][group]" )
+{
+    be::task_pool    pool( 2 );
+    be::task_group   cancelled( pool );
+    be::task_group   other( pool );
+    std::atomic_bool started{ false };
+    std::atomic_bool stopped{ false };
+    cancelled.run( [&]( be::stop_token token ) {
+        started = true;
+        while ( !token )
+        {
+            std::this_thread::yield();
+        }
+        stopped = true;
+    } );
+    REQUIRE( eventually( [&] { return started.load(); } ) );
+
+    pool.pause();
+    std::atomic_int ran{ 0 };
+    cancelled.run( [&ran]() { ++ran; } );
+    other.run( [&ran]() { ran += 10; } );
+    cancelled.cancel();
+    REQUIRE( cancelled.is_cancelled() );
+    REQUIRE_FALSE( other.is_cancelled() );
+    pool.unpause();
+
+    cancelled.wait();
+    other.wait();
+    REQUIRE( stopped );
+    REQUIRE( ran == 10 );
+}
+
+namespace {
+std::size_t group_sum( be::task_pool& pool, std::size_t begin, std::size_t end )
+{
+    if ( end - begin <= 4 )
+    {
+        std::size_t sum = 0;
+        for ( ; begin != end; ++begin )
+        {
+            sum += begin;
+        }
+        return sum;
+    }
+    std::size_t const middle = begin + ( end - begin ) / 2;
+    std::size_t       lhs    = 0;
+    std::size_t       rhs    = 0;
+    be::task_group    group( pool );
+    group.run( [&]() { lhs = group_sum( pool, begin, middle ); } );
+    group.run( [&]() { rhs = group_sum( pool, middle, end ); } );
+    group.wait();
+    return lhs + rhs;
+}
+} // namespace
+
+TEST_CASE( "task group/nested", "[task_pool][group]" )
+{
+    // every level waits for its group on a single thread
+    be::task_pool pool( 1 );
+    auto sum = pool.submit( std::launch::async, [&pool]() { return group_sum( pool, 0, 1000 ); } );
+    REQUIRE( sum.get() == 499500 );
+    REQUIRE( group_sum( pool, 0, 1000 ) == 499500 );
+}
+
+TEST_CASE( "task group/rejected", "[task_pool][group][capacity]" )
+{
+    be::pool_options options;
+    options.thread_count   = 1;
+    options.queue_capacity = 1;
+    options.overflow       = be::overflow_policy::reject;
+    be::task_pool   pool( options );
+    be::task_group  group( pool );
+    std::atomic_int ran{ 0 };
+    pool.pause();
+    group.run( [&ran]() { ++ran; } );
+    group.run( [&ran]() { ++ran; } );
+    pool.unpause();
+    try
+    {
+        group.wait();
+        FAIL( "the rejected task did not fail the group" );
+    }
+    catch ( std::future_error const& error )
+    {
+        REQUIRE( error.code() == std::future_errc::broken_promise );
+    }
+    REQUIRE( ran == 0 );
+}
+
+TEST_CASE( "stop source/queued tasks", "[stop_token]" )
+{
+    be::task_pool    pool( 1 );
+    be::stop_source  source;
+    std::atomic_int  ran{ 0 };
+    std::promise< int > input;
+    pool.pause();
+    auto queued = pool.submit( { std::launch::async, source.get_token() }, [&ran] { ++ran; } );
+    auto polled = pool.submit(
+        { std::launch::async, source.get_token() },
+        [&ran]( int value ) { ran += value; },
+        input.get_future() );
+    auto other = pool.submit( std::launch::async, [&ran] { ran += 10; } );
+    REQUIRE( source.request_stop() );
+    REQUIRE_FALSE( source.request_stop() );
+    pool.unpause();
+
+    REQUIRE_THROWS_AS( queued.get(), be::task_cancelled );
+    REQUIRE_THROWS_AS( polled.get(), be::task_cancelled );
+    other.get();
+    REQUIRE( ran == 10 );
+    REQUIRE( pool.get_tasks_queued() == 0U );
+
+    // tasks submitted after the source fired are cancelled as well
+    auto late = pool.submit( { std::launch::async, source.get_token() }, [&ran] { ++ran; } );
+    REQUIRE_THROWS_AS( late.get(), be::task_cancelled );
+    REQUIRE( ran == 10 );
+}
+
+TEST_CASE( "stop source/chained to the pool", "[stop_token]" )
+{
+    be::stop_source  source;
+    std::atomic_bool started{ false };
+    auto             work = [&started]( be::stop_token token ) {
+        started = true;
+        while ( !token )
+        {
+            std::this_thread::yield();
+        }
+    };
+    {
+        be::task_pool pool( 1 );
+        auto          f = pool.submit( { std::launch::async, source.get_token() }, work );
+        REQUIRE( eventually( [&] { return started.load(); } ) );
+        source.request_stop();
+        f.get();
+    }
+    // a source that never fires leaves it to the pool
+    started = false;
+    be::stop_source other;
+    {
+        be::task_pool pool( 1 );
+        pool.submit( { std::launch::async, other.get_token() }, work );
+        REQUIRE( eventually( [&] { return started.load(); } ) );
+    }
+    REQUIRE_FALSE( other.stop_requested() );
+}
+
+TEST_CASE( "stop source/callbacks", "[stop_token]" )
+{
+    be::stop_source source;
+    int             called = 0;
+    {
+        be::stop_callback< std::function< void() > > callback( source.get_token(),
+                                                               [&called] { ++called; } );
+        be::stop_callback< std::function< void() > > removed( source.get_token(),
+                                                              [&called] { called += 10; } );
+    }
+    be::stop_callback< std::function< void() > > callback( source.get_token(),
+                                                           [&called] { ++called; } );
+    REQUIRE( called == 0 );
+    source.request_stop();
+    source.request_stop();
+    REQUIRE( called == 1 );
+
+    // registering with a token that fired runs the callback right away
+    be::stop_callback< std::function< void() > > late( source.get_token(),
+                                                       [&called] { ++called; } );
+    REQUIRE( called == 2 );
+
+    be::stop_token const never;
+    REQUIRE_FALSE( never.stop_possible() );
+    REQUIRE_FALSE( never );
+}
+
+TEST_CASE( "timers/wheel", "[timers]" )
+{
+    be::detail::timer_wheel< int > wheel;
+    std::vector< int >             expired;
+    auto                           collect = [&expired]( int&& value ) { expired.push_back( value ); };
+    // one tick on each level and one beyond the last
+    std::uint64_t const ticks[] = { 5, 100, 5'000, 300'000, 20'000'000 }; // NOLINT (c-arrays)
+    for ( int i = 4; i >= 0; --i )
+    {
+        REQUIRE( wheel.add( ticks[i], i ) );
+    }
+    int past = 9;
+    REQUIRE( wheel.add( 3, past ) );
+    REQUIRE( wheel.size() == 6U );
+    REQUIRE( wheel.next_tick() == 3U );
+
+    for ( int i = 0; i < 5; ++i )
+    {
+        wheel.advance( ticks[i] - 1U, collect );
+        REQUIRE( expired.size() == static_cast< std::size_t >( i ) + 1U );
+        wheel.advance( ticks[i], collect );
+        REQUIRE( expired.back() == i );
+    }
+    REQUIRE( expired.front() == 9 );
+    REQUIRE( wheel.size() == 0U );
+    REQUIRE( wheel.next_tick() == be::detail::timer_wheel< int >::never );
+
+    // ticks that passed are refused
+    int late = 1;
+    REQUIRE_FALSE( wheel.add( wheel.current(), late ) );
+}
+
+TEST_CASE( "timers/after and at", "[task_pool][timers]" )
+{
+    be::task_pool pool( 2 );
+    using clock = std::chrono::steady_clock;
+    std::promise< clock::time_point > after;
+    std::promise< clock::time_point > at;
+    auto const                        start = clock::now();
+    pool.submit_after( std::chrono::milliseconds( 20 ), [&after] { after.set_value( clock::now() ); } );
+    pool.submit_at( std::chrono::system_clock::now() + std::chrono::milliseconds( 10 ),
+                    [&at] { at.set_value( clock::now() ); } );
+    REQUIRE( pool.get_timers_pending() == 2U );
+    REQUIRE( at.get_future().get() - start >= std::chrono::milliseconds( 10 ) );
+    REQUIRE( after.get_future().get() - start >= std::chrono::milliseconds( 20 ) );
+    REQUIRE( eventually( [&] { return pool.get_timers_pending() == 0U; } ) );
+
+    // a time that has passed runs with the next tick
+    std::promise< int > passed;
+    pool.submit_at( clock::now() - std::chrono::seconds( 1 ), [&passed]( int value ) { passed.set_value( value ); }, 7 );
+    REQUIRE( passed.get_future().get() == 7 );
+}
+
+TEST_CASE( "timers/every", "[task_pool][timers]" )
+{
+    be::task_pool   pool( 1 );
+    std::atomic_int runs{ 0 };
+    auto            timer = pool.submit_every( std::chrono::milliseconds( 2 ), [&runs] {
+        ++runs;
+        throw std::runtime_error( "discarded" );
+    } );
+    REQUIRE( eventually( [&] { return runs >= 3; } ) );
+    timer.cancel();
+    REQUIRE( timer.is_cancelled() );
+    REQUIRE( eventually( [&] { return pool.get_timers_pending() == 0U; } ) );
+    pool.wait();
+    int const stopped = runs;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    REQUIRE( runs == stopped );
+}
+
+TEST_CASE( "timers/cancel", "[task_pool][timers][stop_token]" )
+{
+    be::task_pool   pool( 1 );
+    std::atomic_int runs{ 0 };
+    auto cancelled = pool.submit_after( std::chrono::milliseconds( 5 ), [&runs] { ++runs; } );
+    cancelled.cancel();
+
+    // the stop token of the options cancels the timer as well
+    be::stop_source source;
+    pool.submit_every( { std::launch::async, source.get_token() },
+                       std::chrono::milliseconds( 1 ),
+                       [&runs] { ++runs; } );
+    source.request_stop();
+
+    // running tasks see the token of the handle
+    std::atomic_bool started{ false };
+    auto             running = pool.submit_after( std::chrono::milliseconds( 1 ),
+                                      [&started]( be::stop_token token ) {
+                                          started = true;
+                                          while ( !token )
+                                          {
+                                              std::this_thread::yield();
+                                          }
+                                      } );
+    REQUIRE( eventually( [&] { return started.load(); } ) );
+    running.cancel();
+    REQUIRE( eventually( [&] { return pool.get_timers_pending() == 0U; } ) );
+    pool.wait();
+    REQUIRE( runs == 0 );
+}
+
+TEST_CASE( "deadlines/expired tasks", "[task_pool][deadline]" )
+{
+    be::task_pool       pool( 1 );
+    std::atomic_int     ran{ 0 };
+    std::promise< int > input;
+    auto const          now = std::chrono::steady_clock::now();
+    pool.pause();
+    auto expired = pool.submit( { std::launch::async, now + 1ms }, [&ran] { ++ran; } );
+    auto in_time = pool.submit( { std::launch::async, now + 1h }, [&ran] { return ++ran; } );
+    auto lazy    = pool.submit(
+        { std::launch::async, now + 1ms }, [&ran]( int value ) { ran += value; }, input.get_future() );
+    std::this_thread::sleep_for( 5ms );
+    pool.unpause();
+
+    REQUIRE_THROWS_AS( expired.get(), be::deadline_exceeded );
+    REQUIRE( in_time.get() == 1 );
+    // tasks waiting for their arguments are not kept past their deadline either
+    REQUIRE_THROWS_AS( lazy.get(), be::task_cancelled );
+    REQUIRE( ran == 1 );
+#if BE_TASK_STATS
+    REQUIRE( pool.stats().total().deadline_misses == 2U );
+#endif
+}
+
+TEST_CASE( "deadlines/earliest deadline first", "[task_pool][deadline]" )
+{
+    be::task_pool_t< std::allocator< void >, be::deadline_ready_queue > pool( 1 );
+    std::vector< int >                                                  order;
+    std::vector< std::future< void > >                                  done;
+    auto const now = std::chrono::steady_clock::now();
+    pool.pause();
+    done.push_back( pool.submit( std::launch::async, [&order] { order.push_back( 5 ); } ) );
+    for ( int const i : { 3, 1, 4, 2 } )
+    {
+        done.push_back( pool.submit( { std::launch::async, now + std::chrono::hours( i ) },
+                                     [&order, i] { order.push_back( i ); } ) );
+    }
+    pool.unpause();
+    // not wait() which would run tasks on this thread as well
+    for ( auto& task : done )
+    {
+        task.get();
+    }
+    REQUIRE( order == std::vector< int >{ 1, 2, 3, 4, 5 } );
+}
+
+TEST_CASE( "many pipelines", "[pipe]" )
+{
+    be::task_pool                     pool;
+    static const int                  s_count = 1'000;
+    std::vector< std::future< int > > results;
+    for ( int i = 0; i < s_count; ++i )
+    {
+        auto pipe = pool | [i]() { return i; } | []( int x ) { return x + 1; } |
+                    []( int x ) { return x * 2; };
+        results.push_back( static_cast< decltype( pipe )::future_type >( pipe ) );
+    }
+    for ( int i = 0; i < s_count; ++i )
+    {
+        REQUIRE( results[static_cast< std::size_t >( i )].get() == ( i + 1 ) * 2 );
+    }
+}